@@ -0,0 +1,223 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "slipc.h"
+
+/**
+ * \brief Payload of len bytes with special_permille END/ESC bytes per 1000.
+ */
+static std::vector<uint8_t> make_payload(size_t len,
+                                         unsigned special_permille) {
+  std::mt19937 rng(len + special_permille);
+  std::uniform_int_distribution<unsigned> byte_dist(0, 255);
+  std::uniform_int_distribution<unsigned> permille_dist(0, 999);
+
+  std::vector<uint8_t> payload(len);
+  for (auto &byte : payload) {
+    if (permille_dist(rng) < special_permille) {
+      byte = byte_dist(rng) & 1 ? SLIPC_END : SLIPC_ESC;
+    } else {
+      do {
+        byte = byte_dist(rng);
+      } while (byte == SLIPC_END || byte == SLIPC_ESC);
+    }
+  }
+  return payload;
+}
+
+static std::vector<uint8_t> make_encoded(std::vector<uint8_t> const &payload) {
+  std::vector<uint8_t> encoded(SLIPC_ENCODED_SIZE_MAX(payload.size(), false));
+  slipc_io_buffer_writer_t writer_ctx;
+  auto writer =
+      slipc_io_writer_from_buffer(&writer_ctx, encoded.data(), encoded.size());
+  slipc_encode_packet(&writer, payload.data(), payload.size(), false);
+  encoded.resize(encoded.size() - writer_ctx.len);
+  return encoded;
+}
+
+/**
+ * \brief Report bytes/s of the payload and time per frame.
+ */
+static void set_counters(benchmark::State &state, size_t payload_len,
+                         size_t frames = 1) {
+  state.SetBytesProcessed(int64_t(state.iterations() * payload_len * frames));
+  state.counters["frame"] = benchmark::Counter(
+      double(state.iterations() * frames),
+      benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+
+static void payload_args(benchmark::internal::Benchmark *bench) {
+  bench->ArgNames({"len", "permille"});
+  bench->ArgsProduct({
+      benchmark::CreateRange(16, 1 << 20, 8),
+      {0, 10, 500, 1000},
+  });
+}
+
+static void BM_EncodePacket(benchmark::State &state) {
+  auto const payload = make_payload(state.range(0), state.range(1));
+  std::vector<uint8_t> out(SLIPC_ENCODED_SIZE_MAX(payload.size(), false));
+
+  for (auto _ : state) {
+    slipc_io_buffer_writer_t writer_ctx;
+    auto writer =
+        slipc_io_writer_from_buffer(&writer_ctx, out.data(), out.size());
+    auto res =
+        slipc_encode_packet(&writer, payload.data(), payload.size(), false);
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+  set_counters(state, payload.size());
+}
+BENCHMARK(BM_EncodePacket)->Apply(payload_args);
+
+static void BM_EncodePacketVec(benchmark::State &state) {
+  auto const payload = make_payload(state.range(0), state.range(1));
+
+  struct Sink {
+    size_t len = 0;
+
+    static slipc_io_writer_result_t write(slipc_io_user_ctx_t user_ctx,
+                                          slipc_io_vec_t const *vecs,
+                                          size_t *count) {
+      auto &sink = *static_cast<Sink *>(user_ctx.ctx);
+      for (size_t i = 0; i < *count; i++) {
+        sink.len += vecs[i].len;
+      }
+      return SLIPC_IO_WRITER_OK;
+    }
+  } sink;
+  slipc_io_vec_writer_t writer = {{&sink}, Sink::write};
+
+  for (auto _ : state) {
+    auto res =
+        slipc_encode_packet_vec(&writer, payload.data(), payload.size(), false);
+    benchmark::DoNotOptimize(res);
+  }
+  benchmark::DoNotOptimize(sink.len);
+  set_counters(state, payload.size());
+}
+BENCHMARK(BM_EncodePacketVec)->Apply(payload_args);
+
+static void BM_EncoderTransfer(benchmark::State &state) {
+  auto const payload = make_payload(state.range(0), state.range(1));
+  std::vector<uint8_t> out(SLIPC_ENCODED_SIZE_MAX(payload.size(), false));
+  uint8_t chunk[SLIPC_TRANSFER_CHUNK_SIZE];
+
+  for (auto _ : state) {
+    slipc_io_buffer_reader_t reader_ctx;
+    auto reader = slipc_io_reader_from_buffer(&reader_ctx, payload.data(),
+                                              payload.size());
+    slipc_io_buffer_writer_t writer_ctx;
+    auto writer =
+        slipc_io_writer_from_buffer(&writer_ctx, out.data(), out.size());
+    auto encoder = slipc_encoder_new(false);
+    slipc_encoder_set_chunk(&encoder, chunk, sizeof(chunk));
+    auto res = slipc_encoder_transfer(&encoder, &reader, &writer);
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+  set_counters(state, payload.size());
+}
+BENCHMARK(BM_EncoderTransfer)->Apply(payload_args);
+
+static void BM_EncodedSize(benchmark::State &state) {
+  auto const payload = make_payload(state.range(0), state.range(1));
+
+  for (auto _ : state) {
+    auto size = slipc_encoded_size(payload.data(), payload.size(), false);
+    benchmark::DoNotOptimize(size);
+  }
+  set_counters(state, payload.size());
+}
+BENCHMARK(BM_EncodedSize)->Apply(payload_args);
+
+static void BM_DecodePacket(benchmark::State &state) {
+  auto const payload = make_payload(state.range(0), state.range(1));
+  auto const encoded = make_encoded(payload);
+  std::vector<uint8_t> out(payload.size() + 1);
+
+  for (auto _ : state) {
+    slipc_io_buffer_writer_t writer_ctx;
+    auto writer =
+        slipc_io_writer_from_buffer(&writer_ctx, out.data(), out.size());
+    auto decoder = slipc_decoder_new(false);
+    auto res = slipc_decoder_decode_packet(&decoder, &writer, encoded.data(),
+                                           encoded.size());
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+  set_counters(state, payload.size());
+}
+BENCHMARK(BM_DecodePacket)->Apply(payload_args);
+
+static void BM_DecoderTransfer(benchmark::State &state) {
+  auto const payload = make_payload(state.range(0), state.range(1));
+  auto const encoded = make_encoded(payload);
+  std::vector<uint8_t> out(payload.size() + 1);
+
+  for (auto _ : state) {
+    slipc_io_buffer_reader_t reader_ctx;
+    auto reader = slipc_io_reader_from_buffer(&reader_ctx, encoded.data(),
+                                              encoded.size());
+    slipc_io_buffer_writer_t writer_ctx;
+    auto writer =
+        slipc_io_writer_from_buffer(&writer_ctx, out.data(), out.size());
+    auto decoder = slipc_decoder_new(false);
+    auto res = slipc_decoder_transfer(&decoder, &reader, &writer);
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+  set_counters(state, payload.size());
+}
+BENCHMARK(BM_DecoderTransfer)->Apply(payload_args);
+
+static void BM_DecoderFeed(benchmark::State &state) {
+  auto const payload = make_payload(state.range(0), state.range(1));
+  auto const encoded = make_encoded(payload);
+  std::vector<uint8_t> out(payload.size());
+
+  for (auto _ : state) {
+    auto decoder = slipc_decoder_new(false);
+    size_t in_len = encoded.size();
+    size_t out_len = out.size();
+    auto res = slipc_decoder_feed(&decoder, encoded.data(), &in_len,
+                                  out.data(), &out_len);
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+  set_counters(state, payload.size());
+}
+BENCHMARK(BM_DecoderFeed)->Apply(payload_args);
+
+static void BM_DecodeFrames(benchmark::State &state) {
+  size_t const frame_len = state.range(0);
+  size_t const frame_count = (64 * 1024) / frame_len;
+  auto const payload = make_payload(frame_len, state.range(1));
+  auto const frame = make_encoded(payload);
+
+  std::vector<uint8_t> encoded;
+  for (size_t i = 0; i < frame_count; i++) {
+    encoded.insert(encoded.end(), frame.begin(), frame.end());
+  }
+  std::vector<uint8_t> out(frame_count * frame_len);
+  std::vector<slipc_frame_desc_t> frames(frame_count);
+
+  for (auto _ : state) {
+    auto decoder = slipc_decoder_new(false);
+    size_t len = encoded.size();
+    size_t count = frames.size();
+    auto res = slipc_decoder_decode_frames(&decoder, encoded.data(), &len,
+                                           out.data(), out.size(),
+                                           frames.data(), &count);
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+  set_counters(state, frame_len, frame_count);
+}
+BENCHMARK(BM_DecodeFrames)
+    ->ArgNames({"len", "permille"})
+    ->ArgsProduct({{16, 64, 256, 1500}, {0, 10, 500, 1000}});
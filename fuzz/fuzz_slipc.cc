@@ -0,0 +1,930 @@
+// Differential fuzz target: every buffer, stream and bulk path of the encoder
+// and decoder has to match slipc_encode_byte() and slipc_decode_byte(). So do
+// the framer, the channel manager, the parallel decoder, slipc.hpp and the
+// encoders and decoders with a checksum.
+//
+// Built as a libFuzzer target with Clang, which AFL++ runs as well through
+// afl-clang-fast++. Other compilers build a driver that replays the files
+// given on the command line, or random inputs without arguments. Set
+// SLIPC_FUZZ_THROUGHPUT to print the throughput of every path on exit.
+//
+// Every input runs with each scan kernel the CPU supports. The scalar kernel
+// decodes into memory with the table decoder, the others with the scan.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <vector>
+
+#include "slipc.h"
+#include "slipc.hpp"
+#include "slipc_framer.h"
+#include "slipc_mux.h"
+#ifdef SLIPC_FUZZ_PARALLEL
+#include "slipc_parallel.h"
+#endif
+
+#define FUZZ_CHECK(cond) ((cond) ? (void)0 : fuzz_fail(#cond, __LINE__))
+
+[[noreturn]] static void fuzz_fail(char const *what, int line) {
+  std::fprintf(stderr, "fuzz_slipc.cc:%d: check failed: %s\n", line, what);
+  std::abort();
+}
+
+enum Path {
+  PATH_REFERENCE_DECODE,
+  PATH_DECODE_PACKET,
+  PATH_DECODE_IN_PLACE,
+  PATH_FEED,
+  PATH_DECODE_FRAMES,
+  PATH_DECODER_TRANSFER,
+  PATH_DECODE_PARALLEL,
+  PATH_DECODE_HPP,
+  PATH_FRAMER,
+  PATH_MUX,
+  PATH_REFERENCE_ENCODE,
+  PATH_ENCODE_PACKET,
+  PATH_ENCODE_VEC,
+  PATH_ENCODER_WRITE,
+  PATH_ENCODER_TRANSFER,
+  PATH_ENCODE_FRAMES,
+  PATH_ENCODE_HPP,
+  PATH_CRC_16,
+  PATH_CRC_32,
+  PATH_COUNT,
+};
+
+static char const *const path_names[PATH_COUNT] = {
+    "reference decode", "decode packet",    "decode in place",
+    "feed",             "decode frames",    "decoder transfer",
+    "decode parallel",  "decode c++",       "framer",
+    "channel manager",  "reference encode", "encode packet",
+    "encode vec",       "encoder write",    "encoder transfer",
+    "encode frames",    "encode c++",       "crc-16",
+    "crc-32",
+};
+
+static struct {
+  uint64_t bytes;
+  std::chrono::nanoseconds time;
+} throughput[SLIPC_KERNEL_COUNT][PATH_COUNT];
+
+/**
+ * \brief Run one path and add its time and input to its throughput.
+ */
+template <typename F> static void timed(Path path, size_t bytes, F &&run) {
+  auto &entry = throughput[slipc_kernel_get()][path];
+  auto const start = std::chrono::steady_clock::now();
+  run();
+  entry.time += std::chrono::steady_clock::now() - start;
+  entry.bytes += bytes;
+}
+
+static void print_throughput() {
+  std::fprintf(stderr, "%-8s %-18s %12s %10s %10s\n", "kernel", "path",
+               "bytes", "ms", "MB/s");
+  for (int k = 0; k < SLIPC_KERNEL_COUNT; k++) {
+    for (int i = 0; i < PATH_COUNT; i++) {
+      auto const &entry = throughput[k][i];
+      if (entry.bytes == 0) {
+        continue;
+      }
+      double const ms = entry.time.count() / 1e6;
+      double const mbps = ms > 0 ? entry.bytes / ms / 1e3 : 0;
+      std::fprintf(stderr, "%-8s %-18s %12llu %10.1f %10.1f\n",
+                   slipc_kernel_name((slipc_kernel_t)k), path_names[i],
+                   (unsigned long long)entry.bytes, ms, mbps);
+    }
+  }
+}
+
+// Never NULL, the packet functions assert a buffer even for zero bytes.
+static uint8_t const no_data[1] = {0};
+
+static uint8_t const *data_or_dummy(std::vector<uint8_t> const &buf) {
+  return buf.empty() ? no_data : buf.data();
+}
+
+/**
+ * \brief Writer into a vector, taking budget bytes per call at most.
+ */
+struct VecWriter : slipc_io_writer_t {
+  std::vector<uint8_t> buf;
+  size_t budget;
+
+  VecWriter(size_t budget = SIZE_MAX)
+      : slipc_io_writer_t{{this}, write_cb}, budget(budget) {}
+
+  static slipc_io_writer_result_t
+  write_cb(slipc_io_user_ctx_t uctx, uint8_t const *data, size_t *len) {
+    auto &ctx = *static_cast<VecWriter *>(uctx.ctx);
+    size_t const n = std::min(*len, ctx.budget);
+    ctx.buf.insert(ctx.buf.end(), data, data + n);
+
+    bool const all = n == *len;
+    *len = n;
+    return all ? SLIPC_IO_WRITER_OK : SLIPC_IO_WRITER_AGAIN;
+  }
+};
+
+struct VecVecWriter : slipc_io_vec_writer_t {
+  std::vector<uint8_t> buf;
+
+  VecVecWriter() : slipc_io_vec_writer_t{{this}, write_cb} {}
+
+  static slipc_io_writer_result_t write_cb(slipc_io_user_ctx_t uctx,
+                                           slipc_io_vec_t const *vecs,
+                                           size_t *count) {
+    auto &ctx = *static_cast<VecVecWriter *>(uctx.ctx);
+    for (size_t i = 0; i < *count; i++) {
+      ctx.buf.insert(ctx.buf.end(), vecs[i].data, vecs[i].data + vecs[i].len);
+    }
+    return SLIPC_IO_WRITER_OK;
+  }
+};
+
+/**
+ * \brief Reader returning chunks of at most chunk bytes.
+ *
+ * With eof_with_data the last chunk comes with SLIPC_IO_READER_EOF, else an
+ * extra empty read returns it.
+ */
+struct ChunkReader : slipc_io_reader_t {
+  std::vector<uint8_t> const &buf;
+  size_t pos = 0;
+  size_t chunk;
+  bool eof_with_data;
+
+  ChunkReader(std::vector<uint8_t> const &buf, size_t chunk,
+              bool eof_with_data)
+      : slipc_io_reader_t{{this}, read_cb}, buf(buf), chunk(chunk),
+        eof_with_data(eof_with_data) {}
+
+  static slipc_io_reader_result_t read_cb(slipc_io_user_ctx_t uctx,
+                                          uint8_t *data, size_t *len) {
+    auto &ctx = *static_cast<ChunkReader *>(uctx.ctx);
+    size_t const n = std::min({*len, ctx.chunk, ctx.buf.size() - ctx.pos});
+    std::copy_n(ctx.buf.begin() + ctx.pos, n, data);
+    ctx.pos += n;
+    *len = n;
+
+    bool const done = ctx.pos == ctx.buf.size();
+    return done && (ctx.eof_with_data || n == 0) ? SLIPC_IO_READER_EOF
+                                                 : SLIPC_IO_READER_MORE;
+  }
+};
+
+struct Frame {
+  std::vector<uint8_t> data;
+  bool malformed = false;
+
+  bool operator==(Frame const &) const = default;
+};
+
+/**
+ * \brief Frame callback collecting the frames of a framer or channel.
+ */
+struct FrameSink {
+  std::vector<Frame> frames;
+
+  static void on_frame(slipc_io_user_ctx_t uctx, uint8_t const *frame,
+                       size_t len, bool malformed) {
+    auto &ctx = *static_cast<FrameSink *>(uctx.ctx);
+    ctx.frames.push_back({{frame, frame + len}, malformed});
+  }
+};
+
+/**
+ * \brief Check if a decoder with a checksum reports a frame as corrupted.
+ */
+static bool crc_fails(Frame const &frame, slipc_crc_kind_t kind) {
+  if (kind == SLIPC_CRC_NONE || frame.data.empty()) {
+    return false;
+  }
+  uint32_t const crc = slipc_crc_update(kind, slipc_crc_init(kind),
+                                        frame.data.data(), frame.data.size());
+  return !slipc_crc_check(kind, crc);
+}
+
+/**
+ * \brief Frames the framer and the channel manager deliver, corrupted ones
+ * dropped and the checksum cut off the others.
+ */
+static std::vector<Frame> delivered_frames(std::vector<Frame> const &frames,
+                                           slipc_crc_kind_t kind) {
+  size_t const crc_len = slipc_crc_size(kind);
+  std::vector<Frame> delivered;
+  for (auto const &frame : frames) {
+    if (crc_fails(frame, kind)) {
+      continue;
+    }
+    Frame payload = frame;
+    payload.data.resize(frame.data.size() > crc_len
+                            ? frame.data.size() - crc_len
+                            : 0);
+    delivered.push_back(payload);
+  }
+  return delivered;
+}
+
+/**
+ * \brief Frames of a stream as decoded by slipc_decode_byte().
+ */
+struct Expected {
+  slipc_decoder_result_t first; /**< Result for the first packet */
+  size_t first_end;             /**< End of the first frame, or input size */
+  std::vector<Frame> frames;    /**< Complete frames */
+  Frame partial;                /**< Unterminated frame at the end */
+  size_t consumed;              /**< End of the last complete frame */
+  bool noise_tail;              /**< Stream ends without a start byte */
+};
+
+/**
+ * \brief Split a stream into frames with slipc_decode_byte() only.
+ *
+ * Every frame starts from a fresh decoder, the paths that keep a decoder
+ * across frames have to behave the same.
+ */
+static Expected reference_decode(std::vector<uint8_t> const &input,
+                                 bool startbyte) {
+  Expected exp = {SLIPC_DECODER_NOT_FOUND, input.size(), {}, {}, 0, false};
+  size_t pos = 0;
+
+  while (1) {
+    if (startbyte) {
+      auto it = std::find(input.begin() + pos, input.end(), SLIPC_END);
+      if (it == input.end()) {
+        exp.noise_tail = true;
+        break;
+      }
+      pos = it - input.begin() + 1;
+    }
+    if (pos == input.size()) {
+      break;
+    }
+
+    auto decoder = slipc_decoder_new(startbyte);
+    VecWriter writer;
+    bool complete = false;
+    for (; pos < input.size() && !complete; pos++) {
+      complete = slipc_decode_byte(&decoder, &writer, input[pos]) ==
+                 SLIPC_DECODER_EOF;
+    }
+
+    Frame frame = {writer.buf, decoder.malformed};
+    if (exp.frames.empty()) {
+      exp.first = complete ? SLIPC_DECODER_EOF : SLIPC_DECODER_MORE;
+      exp.first_end = complete ? pos : input.size();
+    }
+    if (!complete) {
+      exp.partial = frame;
+      break;
+    }
+    exp.frames.push_back(frame);
+    exp.consumed = pos;
+  }
+  return exp;
+}
+
+/**
+ * \brief Parameters taken from the first byte of the input.
+ */
+struct Options {
+  bool startbyte;     /**< Frames start with an END byte */
+  size_t chunk;       /**< Input chunk size */
+  size_t out_chunk;   /**< Output chunk size */
+  bool eof_with_data; /**< Reader returns EOF with its last chunk */
+};
+
+static Options parse_options(uint8_t byte) {
+  static size_t const sizes[8] = {1, 2, 3, 7, 16, 63, 64, 4096};
+  return {
+      .startbyte = (byte & 1) != 0,
+      .chunk = sizes[(byte >> 1) & 7],
+      .out_chunk = sizes[(byte >> 4) & 7],
+      .eof_with_data = (byte & 0x80) != 0,
+  };
+}
+
+static void check_decode_packet(std::vector<uint8_t> const &input,
+                                Options const &opt, Expected const &exp) {
+  auto decoder = slipc_decoder_new(opt.startbyte);
+  VecWriter writer;
+  auto res = slipc_decoder_decode_packet(&decoder, &writer,
+                                         data_or_dummy(input), input.size());
+
+  Frame const &want = exp.frames.empty() ? exp.partial : exp.frames[0];
+  FUZZ_CHECK(res == exp.first);
+  if (res != SLIPC_DECODER_NOT_FOUND) {
+    FUZZ_CHECK(writer.buf == want.data);
+    FUZZ_CHECK(decoder.malformed == want.malformed);
+  }
+}
+
+static void check_in_place(std::vector<uint8_t> const &input,
+                           Options const &opt, Expected const &exp) {
+  auto buf = input;
+  std::vector<Frame> frames;
+  Frame partial;
+  size_t pos = 0;
+
+  while (pos < buf.size()) {
+    auto decoder = slipc_decoder_new(opt.startbyte);
+    size_t len = buf.size() - pos;
+    size_t out_len;
+    auto res = slipc_decoder_decode_packet_in_place(&decoder, buf.data() + pos,
+                                                    &len, &out_len);
+    Frame frame = {{buf.begin() + pos, buf.begin() + pos + out_len},
+                   decoder.malformed};
+    if (res != SLIPC_DECODER_EOF) {
+      if (res == SLIPC_DECODER_MORE) {
+        partial = frame;
+      }
+      break;
+    }
+    frames.push_back(frame);
+    pos += len;
+  }
+
+  FUZZ_CHECK(frames == exp.frames);
+  FUZZ_CHECK(partial == exp.partial);
+}
+
+static void check_feed(std::vector<uint8_t> const &input, Options const &opt,
+                       Expected const &exp) {
+  auto decoder = slipc_decoder_new(opt.startbyte);
+  std::vector<uint8_t> out(opt.out_chunk);
+  std::vector<Frame> frames;
+  Frame frame;
+  size_t pos = 0;
+
+  while (pos < input.size()) {
+    size_t in_len = std::min(opt.chunk, input.size() - pos);
+    size_t out_len = out.size();
+    auto res = slipc_decoder_feed(&decoder, input.data() + pos, &in_len,
+                                  out.data(), &out_len);
+    FUZZ_CHECK(res != SLIPC_DECODER_IO_ERROR);
+    FUZZ_CHECK(in_len > 0 || out_len > 0);
+
+    pos += in_len;
+    frame.data.insert(frame.data.end(), out.begin(), out.begin() + out_len);
+    if (res == SLIPC_DECODER_EOF) {
+      frame.malformed = decoder.malformed;
+      frames.push_back(frame);
+      frame = {};
+    }
+  }
+  frame.malformed = decoder.in_frame && decoder.malformed;
+
+  FUZZ_CHECK(frames == exp.frames);
+  FUZZ_CHECK(frame == exp.partial);
+}
+
+static void check_decode_frames(std::vector<uint8_t> const &input,
+                                Options const &opt, Expected const &exp,
+                                slipc_crc_kind_t kind = SLIPC_CRC_NONE) {
+  auto decoder = slipc_decoder_new(opt.startbyte);
+  slipc_decoder_set_crc(&decoder, kind);
+  std::vector<uint8_t> out(input.size() + 1);
+  std::vector<slipc_frame_desc_t> descs(exp.frames.size() + 1);
+  size_t len = input.size();
+  size_t count = descs.size();
+  auto res = slipc_decoder_decode_frames(&decoder, data_or_dummy(input), &len,
+                                         out.data(), out.size(), descs.data(),
+                                         &count);
+
+  FUZZ_CHECK(res == SLIPC_DECODER_MORE);
+  FUZZ_CHECK(len == (exp.noise_tail ? input.size() : exp.consumed));
+  FUZZ_CHECK(count == exp.frames.size());
+  for (size_t i = 0; i < count; i++) {
+    auto const &desc = descs[i];
+    Frame frame = {{out.begin() + desc.offset,
+                    out.begin() + desc.offset + desc.len},
+                   desc.malformed};
+    FUZZ_CHECK(frame == exp.frames[i]);
+    FUZZ_CHECK(desc.crc_error == crc_fails(exp.frames[i], kind));
+    FUZZ_CHECK(!desc.oversize);
+  }
+
+  // A small output, called again on EOF. Longer frames come truncated.
+  size_t const small = std::min(opt.out_chunk, out.size());
+  decoder = slipc_decoder_new(opt.startbyte);
+  slipc_decoder_set_crc(&decoder, kind);
+  size_t pos = 0;
+  size_t frame = 0;
+  for (size_t calls = 0;; calls++) {
+    FUZZ_CHECK(calls <= exp.frames.size() + 1);
+
+    len = input.size() - pos;
+    count = descs.size();
+    res = slipc_decoder_decode_frames(&decoder, data_or_dummy(input) + pos,
+                                      &len, out.data(), small,
+                                      descs.data(), &count);
+    for (size_t i = 0; i < count; i++, frame++) {
+      FUZZ_CHECK(frame < exp.frames.size());
+      auto const &desc = descs[i];
+      auto const &want = exp.frames[frame].data;
+      FUZZ_CHECK(desc.oversize == (want.size() > small));
+      FUZZ_CHECK(desc.len == std::min(want.size(), small));
+      FUZZ_CHECK(std::equal(out.begin() + desc.offset,
+                            out.begin() + desc.offset + desc.len,
+                            want.begin()));
+    }
+    pos += len;
+
+    if (res == SLIPC_DECODER_MORE) {
+      break;
+    }
+    FUZZ_CHECK(res == SLIPC_DECODER_EOF && (count > 0 || len > 0));
+  }
+  FUZZ_CHECK(frame == exp.frames.size());
+  FUZZ_CHECK(pos == (exp.noise_tail ? input.size() : exp.consumed));
+}
+
+static void check_transfer(std::vector<uint8_t> const &input,
+                           Options const &opt, Expected const &exp) {
+  auto decoder = slipc_decoder_new(opt.startbyte);
+  ChunkReader reader(input, opt.chunk, opt.eof_with_data);
+  std::vector<Frame> frames;
+  Frame partial;
+
+  for (size_t calls = 0;; calls++) {
+    FUZZ_CHECK(calls <= input.size() + 1);
+
+    VecWriter writer;
+    auto res = slipc_decoder_transfer(&decoder, &reader, &writer);
+    Frame frame = {writer.buf, decoder.malformed};
+    if (res != SLIPC_DECODER_EOF) {
+      FUZZ_CHECK(res == SLIPC_DECODER_MORE || res == SLIPC_DECODER_NOT_FOUND);
+      partial = frame;
+      break;
+    }
+    frames.push_back(frame);
+    // Transfers keep the flag until the caller clears it.
+    decoder.malformed = false;
+  }
+
+  FUZZ_CHECK(frames == exp.frames);
+  FUZZ_CHECK(partial == exp.partial);
+}
+
+#ifdef SLIPC_FUZZ_PARALLEL
+static void check_parallel(std::vector<uint8_t> const &input,
+                           Options const &opt) {
+  // Every END ends a frame and frames of only an END are skipped, start byte
+  // or not.
+  auto const exp = reference_decode(input, false);
+  std::vector<Frame> want;
+  size_t end = 0;
+  for (auto const &frame : exp.frames) {
+    size_t const start = end;
+    end = std::find(input.begin() + start, input.end(), SLIPC_END) -
+          input.begin() + 1;
+    if (end - start > 1) {
+      want.push_back(frame);
+    }
+  }
+
+  // One to four threads, room for about half of the frames per call.
+  unsigned const threads = 1 + opt.chunk % 4;
+  size_t const room = want.size() / 2 + 1;
+  std::vector<uint8_t> out(input.size() + 1);
+  std::vector<slipc_frame_desc_t> descs(room);
+  std::vector<Frame> frames;
+  size_t pos = 0;
+
+  for (size_t calls = 0;; calls++) {
+    FUZZ_CHECK(calls <= want.size());
+
+    size_t len = input.size() - pos;
+    size_t count = room;
+    auto res = slipc_decode_parallel(data_or_dummy(input) + pos, &len,
+                                     out.data(), descs.data(), &count,
+                                     threads);
+    for (size_t i = 0; i < count; i++) {
+      auto const &desc = descs[i];
+      frames.push_back({{out.begin() + desc.offset,
+                         out.begin() + desc.offset + desc.len},
+                        desc.malformed});
+    }
+    pos += len;
+
+    if (res == SLIPC_DECODER_MORE) {
+      break;
+    }
+    FUZZ_CHECK(res == SLIPC_DECODER_EOF && count == room);
+  }
+
+  FUZZ_CHECK(frames == want);
+  FUZZ_CHECK(pos == exp.consumed);
+}
+#endif
+
+static slipc_decoder_result_t to_result(slipc::decode_status status) {
+  switch (status) {
+  case slipc::decode_status::eof:
+    return SLIPC_DECODER_EOF;
+  case slipc::decode_status::more:
+    return SLIPC_DECODER_MORE;
+  default:
+    return SLIPC_DECODER_NOT_FOUND;
+  }
+}
+
+static void check_decode_hpp(std::vector<uint8_t> const &input,
+                             Options const &opt, Expected const &exp) {
+  std::vector<uint8_t> out;
+  auto res = slipc::decode(input, std::back_inserter(out), opt.startbyte);
+
+  Frame const &want = exp.frames.empty() ? exp.partial : exp.frames[0];
+  // An incomplete frame ending in an ESC leaves the ESC for the next call.
+  bool const pending = res.status == slipc::decode_status::more &&
+                       input.back() == SLIPC_ESC;
+  FUZZ_CHECK(to_result(res.status) == exp.first);
+  FUZZ_CHECK(res.consumed == exp.first_end - (pending ? 1 : 0));
+  if (res.status != slipc::decode_status::not_found) {
+    FUZZ_CHECK(out == want.data);
+    FUZZ_CHECK(res.malformed == want.malformed);
+  }
+
+  // A span with room for the whole input decodes like the iterator.
+  std::vector<uint8_t> buf(input.size());
+  std::span<uint8_t> const dst(buf);
+  auto span_res = slipc::decode(input, dst, opt.startbyte);
+  FUZZ_CHECK(span_res.status == res.status);
+  FUZZ_CHECK(span_res.consumed == res.consumed);
+  if (res.status != slipc::decode_status::not_found) {
+    FUZZ_CHECK(std::equal(dst.begin(), span_res.out, out.begin(), out.end()));
+  }
+}
+
+static void check_framer(std::vector<uint8_t> const &input,
+                         Options const &opt, Expected const &exp,
+                         slipc_crc_kind_t kind = SLIPC_CRC_NONE) {
+  // Room for any frame, none is dropped for its size.
+  std::vector<uint8_t> buf(input.size() + 1);
+  FrameSink sink;
+  slipc_framer_t framer;
+  slipc_framer_init(&framer, opt.startbyte, buf.data(), buf.size(),
+                    FrameSink::on_frame, {&sink});
+  slipc_decoder_set_crc(&framer.decoder, kind);
+
+  size_t frames = 0;
+  for (size_t pos = 0; pos < input.size(); pos += opt.chunk) {
+    size_t const len = std::min(opt.chunk, input.size() - pos);
+    frames += slipc_framer_feed(&framer, input.data() + pos, len);
+  }
+
+  FUZZ_CHECK(frames == sink.frames.size());
+  FUZZ_CHECK(sink.frames == delivered_frames(exp.frames, kind));
+}
+
+static void check_mux(std::vector<uint8_t> const &input, Options const &opt,
+                      Expected const &exp,
+                      slipc_crc_kind_t kind = SLIPC_CRC_NONE) {
+  size_t const channels = 3;
+  size_t const frame_size = input.size() + 1;
+  std::vector<size_t> arena(
+      slipc_mux_arena_size(channels, frame_size) / sizeof(size_t) + 1);
+  slipc_mux_t mux;
+  slipc_mux_init(&mux, opt.startbyte, channels, frame_size, arena.data(),
+                 arena.size() * sizeof(size_t));
+  slipc_mux_set_crc(&mux, kind);
+
+  std::vector<FrameSink> sinks(channels);
+  for (size_t c = 0; c < channels; c++) {
+    slipc_mux_set_handler(&mux, c, FrameSink::on_frame, {&sinks[c]});
+  }
+
+  // The whole input on every channel, in its own chunk size, interleaved.
+  std::vector<slipc_mux_input_t> inputs;
+  std::vector<size_t> pos(channels);
+  for (bool more = true; more;) {
+    more = false;
+    for (size_t c = 0; c < channels; c++) {
+      size_t const len = std::min(opt.chunk + c, input.size() - pos[c]);
+      if (len > 0) {
+        inputs.push_back({c, input.data() + pos[c], len});
+        pos[c] += len;
+        more = true;
+      }
+    }
+  }
+  size_t const frames =
+      slipc_mux_feed_batch(&mux, inputs.data(), inputs.size());
+
+  auto const want = delivered_frames(exp.frames, kind);
+  FUZZ_CHECK(frames == channels * want.size());
+  for (auto const &sink : sinks) {
+    FUZZ_CHECK(sink.frames == want);
+  }
+}
+
+/**
+ * \brief Encode a packet with slipc_encode_byte() only.
+ */
+static std::vector<uint8_t>
+reference_encode(std::vector<uint8_t> const &payload, bool startbyte) {
+  VecWriter writer;
+  if (startbyte) {
+    writer.buf.push_back(SLIPC_END);
+  }
+  for (auto byte : payload) {
+    FUZZ_CHECK(slipc_encode_byte(&writer, byte) == SLIPC_ENCODER_OK);
+  }
+  writer.buf.push_back(SLIPC_END);
+  return writer.buf;
+}
+
+static void check_encode_packet(std::vector<uint8_t> const &payload,
+                                Options const &opt,
+                                std::vector<uint8_t> const &want) {
+  VecWriter writer;
+  FUZZ_CHECK(slipc_encode_packet(&writer, data_or_dummy(payload),
+                                 payload.size(),
+                                 opt.startbyte) == SLIPC_ENCODER_OK);
+  FUZZ_CHECK(writer.buf == want);
+
+  VecWriter crc_writer;
+  FUZZ_CHECK(slipc_encode_packet_crc(&crc_writer, data_or_dummy(payload),
+                                     payload.size(), opt.startbyte,
+                                     SLIPC_CRC_NONE) == SLIPC_ENCODER_OK);
+  FUZZ_CHECK(crc_writer.buf == want);
+
+  FUZZ_CHECK(slipc_encoded_size(data_or_dummy(payload), payload.size(),
+                                opt.startbyte) == want.size());
+}
+
+static void check_encode_vec(std::vector<uint8_t> const &payload,
+                             Options const &opt,
+                             std::vector<uint8_t> const &want) {
+  VecVecWriter writer;
+  FUZZ_CHECK(slipc_encode_packet_vec(&writer, data_or_dummy(payload),
+                                     payload.size(),
+                                     opt.startbyte) == SLIPC_ENCODER_OK);
+  FUZZ_CHECK(writer.buf == want);
+}
+
+static void check_encoder_write(std::vector<uint8_t> const &payload,
+                                Options const &opt,
+                                std::vector<uint8_t> const &want,
+                                slipc_crc_kind_t kind = SLIPC_CRC_NONE) {
+  auto encoder = slipc_encoder_new(opt.startbyte);
+  slipc_encoder_set_crc(&encoder, kind);
+  VecWriter writer(opt.out_chunk);
+
+  for (size_t calls = 0;; calls++) {
+    FUZZ_CHECK(calls <= want.size());
+    auto res = slipc_encoder_write(&encoder, &writer, data_or_dummy(payload),
+                                   payload.size());
+    if (res == SLIPC_ENCODER_OK) {
+      break;
+    }
+    FUZZ_CHECK(res == SLIPC_ENCODER_AGAIN);
+  }
+  FUZZ_CHECK(writer.buf == want);
+}
+
+static void check_encoder_transfer(std::vector<uint8_t> const &payload,
+                                   Options const &opt,
+                                   std::vector<uint8_t> const &want,
+                                   slipc_crc_kind_t kind = SLIPC_CRC_NONE) {
+  // Single bytes without a chunk buffer, else a chunk of the input size.
+  std::vector<uint8_t> chunk(opt.chunk);
+  auto encoder = slipc_encoder_new(opt.startbyte);
+  slipc_encoder_set_crc(&encoder, kind);
+  if (opt.chunk > 1) {
+    slipc_encoder_set_chunk(&encoder, chunk.data(), chunk.size());
+  }
+  ChunkReader reader(payload, opt.chunk, opt.eof_with_data);
+  VecWriter writer(opt.out_chunk);
+
+  for (size_t calls = 0;; calls++) {
+    FUZZ_CHECK(calls <= want.size());
+    auto res = slipc_encoder_transfer(&encoder, &reader, &writer);
+    if (res == SLIPC_ENCODER_OK) {
+      break;
+    }
+    FUZZ_CHECK(res == SLIPC_ENCODER_AGAIN);
+  }
+  FUZZ_CHECK(writer.buf == want);
+  FUZZ_CHECK(encoder.stats.bytes_in == payload.size());
+}
+
+static void check_encode_frames(std::vector<uint8_t> const &payload,
+                                Options const &opt) {
+  // Split the payload into packets of the input chunk size.
+  std::vector<slipc_io_vec_t> packets;
+  std::vector<uint8_t> want;
+  std::vector<size_t> ends;
+  for (size_t pos = 0; pos < payload.size(); pos += opt.chunk) {
+    size_t const len = std::min(opt.chunk, payload.size() - pos);
+    packets.push_back({payload.data() + pos, len});
+
+    std::vector<uint8_t> part(payload.begin() + pos,
+                              payload.begin() + pos + len);
+    auto encoded = reference_encode(part, opt.startbyte);
+    want.insert(want.end(), encoded.begin(), encoded.end());
+    ends.push_back(want.size());
+  }
+
+  // Exactly fitting, then one byte short.
+  for (size_t shortage : {0, 1}) {
+    if (shortage > want.size()) {
+      break;
+    }
+
+    std::vector<uint8_t> out(want.size() - shortage + 1);
+    std::vector<size_t> offsets(packets.size());
+    size_t len = want.size() - shortage;
+    size_t count = packets.size();
+    auto res = slipc_encode_frames(out.data(), &len, packets.data(), &count,
+                                   offsets.data(), opt.startbyte);
+
+    FUZZ_CHECK(res == (shortage && !packets.empty() ? SLIPC_ENCODER_AGAIN
+                                                    : SLIPC_ENCODER_OK));
+    FUZZ_CHECK(count <= packets.size());
+    FUZZ_CHECK(len == (count ? ends[count - 1] : 0));
+    FUZZ_CHECK(std::equal(out.begin(), out.begin() + len, want.begin()));
+    FUZZ_CHECK(std::equal(offsets.begin(), offsets.begin() + count,
+                          ends.begin()));
+  }
+}
+
+static void check_encode_hpp(std::vector<uint8_t> const &payload,
+                             Options const &opt,
+                             std::vector<uint8_t> const &want) {
+  std::vector<uint8_t> out;
+  slipc::encode(payload, std::back_inserter(out), opt.startbyte);
+  FUZZ_CHECK(out == want);
+  FUZZ_CHECK(slipc::encoded_size(payload, opt.startbyte) == want.size());
+
+  std::vector<uint8_t> buf(want.size());
+  FUZZ_CHECK(slipc::encode(payload, std::span(buf), opt.startbyte) ==
+             want.size());
+  FUZZ_CHECK(buf == want);
+}
+
+/**
+ * \brief Check the encoders and decoders with a checksum.
+ */
+static void check_crc(std::vector<uint8_t> const &input, Options const &opt,
+                      Expected const &exp, slipc_crc_kind_t kind) {
+  uint8_t const *data = data_or_dummy(input);
+  uint32_t const crc =
+      slipc_crc_update(kind, slipc_crc_init(kind), data, input.size());
+  FUZZ_CHECK(kind == SLIPC_CRC_16
+                 ? slipc_crc16(data, input.size()) == crc
+                 : slipc_crc32(data, input.size()) == (crc ^ 0xFFFFFFFF));
+
+  // The payload with its checksum, as the reference encodes it.
+  auto framed = input;
+  uint8_t trailer[SLIPC_CRC_SIZE_MAX];
+  framed.insert(framed.end(), trailer,
+                trailer + slipc_crc_trailer(kind, crc, trailer));
+  auto const want = reference_encode(framed, opt.startbyte);
+
+  VecWriter packet;
+  FUZZ_CHECK(slipc_encode_packet_crc(&packet, data, input.size(),
+                                     opt.startbyte, kind) == SLIPC_ENCODER_OK);
+  FUZZ_CHECK(packet.buf == want);
+  check_encoder_write(input, opt, want, kind);
+  check_encoder_transfer(input, opt, want, kind);
+
+  auto decoder = slipc_decoder_new(opt.startbyte);
+  slipc_decoder_set_crc(&decoder, kind);
+  VecWriter writer;
+  FUZZ_CHECK(slipc_decoder_decode_packet(&decoder, &writer, want.data(),
+                                         want.size()) == SLIPC_DECODER_EOF);
+  FUZZ_CHECK(writer.buf == framed);
+  FUZZ_CHECK(decoder.stats.crc_errors == 0);
+
+  // The input itself as frames that end with a checksum.
+  check_decode_frames(input, opt, exp, kind);
+  check_framer(input, opt, exp, kind);
+  check_mux(input, opt, exp, kind);
+}
+
+static void check_round_trip(std::vector<uint8_t> const &payload,
+                             std::vector<uint8_t> const &encoded,
+                             Options const &opt) {
+  auto exp = reference_decode(encoded, opt.startbyte);
+  FUZZ_CHECK(exp.frames.size() == 1);
+  FUZZ_CHECK(exp.frames[0].data == payload);
+  FUZZ_CHECK(!exp.frames[0].malformed);
+}
+
+extern "C" int LLVMFuzzerInitialize(int *, char ***) {
+  if (std::getenv("SLIPC_FUZZ_THROUGHPUT")) {
+    std::atexit(print_throughput);
+  }
+  return 0;
+}
+
+/**
+ * \brief Check all paths with the kernel in use.
+ */
+static void check_all(std::vector<uint8_t> const &input, Options const &opt) {
+  size_t const n = input.size();
+
+  Expected exp;
+  timed(PATH_REFERENCE_DECODE, n,
+        [&] { exp = reference_decode(input, opt.startbyte); });
+  timed(PATH_DECODE_PACKET, exp.first_end,
+        [&] { check_decode_packet(input, opt, exp); });
+  timed(PATH_DECODE_IN_PLACE, n, [&] { check_in_place(input, opt, exp); });
+  timed(PATH_FEED, n, [&] { check_feed(input, opt, exp); });
+  timed(PATH_DECODE_FRAMES, n, [&] { check_decode_frames(input, opt, exp); });
+  timed(PATH_DECODER_TRANSFER, n, [&] { check_transfer(input, opt, exp); });
+#ifdef SLIPC_FUZZ_PARALLEL
+  timed(PATH_DECODE_PARALLEL, n, [&] { check_parallel(input, opt); });
+#endif
+  timed(PATH_DECODE_HPP, exp.first_end,
+        [&] { check_decode_hpp(input, opt, exp); });
+  timed(PATH_FRAMER, n, [&] { check_framer(input, opt, exp); });
+  timed(PATH_MUX, n, [&] { check_mux(input, opt, exp); });
+
+  // The same bytes as payload.
+  std::vector<uint8_t> want;
+  timed(PATH_REFERENCE_ENCODE, n,
+        [&] { want = reference_encode(input, opt.startbyte); });
+  timed(PATH_ENCODE_PACKET, n, [&] { check_encode_packet(input, opt, want); });
+  timed(PATH_ENCODE_VEC, n, [&] { check_encode_vec(input, opt, want); });
+  timed(PATH_ENCODER_WRITE, n, [&] { check_encoder_write(input, opt, want); });
+  timed(PATH_ENCODER_TRANSFER, n,
+        [&] { check_encoder_transfer(input, opt, want); });
+  timed(PATH_ENCODE_FRAMES, n, [&] { check_encode_frames(input, opt); });
+  timed(PATH_ENCODE_HPP, n, [&] { check_encode_hpp(input, opt, want); });
+  timed(PATH_CRC_16, n, [&] { check_crc(input, opt, exp, SLIPC_CRC_16); });
+  timed(PATH_CRC_32, n, [&] { check_crc(input, opt, exp, SLIPC_CRC_32); });
+  check_round_trip(input, want, opt);
+}
+
+extern "C" int LLVMFuzzerTestOneInput(uint8_t const *data, size_t size) {
+  if (size == 0) {
+    return 0;
+  }
+
+  auto const opt = parse_options(data[0]);
+  std::vector<uint8_t> const input(data + 1, data + size);
+
+  for (int k = SLIPC_KERNEL_AUTO + 1; k < SLIPC_KERNEL_COUNT; k++) {
+    if (slipc_kernel_set((slipc_kernel_t)k)) {
+      check_all(input, opt);
+    }
+  }
+  slipc_kernel_set(SLIPC_KERNEL_AUTO);
+
+  return 0;
+}
+
+#ifdef SLIPC_FUZZ_STANDALONE
+/**
+ * \brief Random input, biased to special bytes and short frames.
+ */
+static std::vector<uint8_t> random_input(std::mt19937 &rng) {
+  static uint8_t const specials[] = {SLIPC_END, SLIPC_ESC, SLIPC_ESC_END,
+                                     SLIPC_ESC_ESC};
+  std::uniform_int_distribution<unsigned> byte_dist(0, 255);
+  std::uniform_int_distribution<size_t> len_dist(1, 600);
+  std::uniform_int_distribution<unsigned> permille_dist(0, 999);
+
+  unsigned const special_permille = permille_dist(rng);
+  std::vector<uint8_t> input(len_dist(rng));
+  input[0] = byte_dist(rng);
+  for (size_t i = 1; i < input.size(); i++) {
+    input[i] = permille_dist(rng) < special_permille ? specials[rng() % 4]
+                                                     : byte_dist(rng);
+  }
+  return input;
+}
+
+int main(int argc, char **argv) {
+  LLVMFuzzerInitialize(&argc, &argv);
+
+  if (argc > 1) {
+    for (int i = 1; i < argc; i++) {
+      std::ifstream file(argv[i], std::ios::binary);
+      std::vector<uint8_t> input((std::istreambuf_iterator<char>(file)),
+                                 std::istreambuf_iterator<char>());
+      LLVMFuzzerTestOneInput(input.data(), input.size());
+    }
+    return 0;
+  }
+
+  char const *runs_env = std::getenv("SLIPC_FUZZ_RUNS");
+  unsigned long const runs =
+      runs_env ? std::strtoul(runs_env, nullptr, 10) : 10000;
+  std::mt19937 rng(1);
+  for (unsigned long i = 0; i < runs; i++) {
+    auto input = random_input(rng);
+    LLVMFuzzerTestOneInput(input.data(), input.size());
+  }
+  return 0;
+}
+#endif
@@ -13,7 +13,10 @@
 #ifndef _SLIPC_H_
 #define _SLIPC_H_
 
+#include "slipc_crc.h"
 #include "slipc_io.h"
+#include "slipc_kernel.h"
+#include "slipc_trace.h"
 
 #include <assert.h>
 #include <stdbool.h>
@@ -24,6 +27,25 @@
 extern "C" {
 #endif
 
+/**
+ * \brief Bytes slipc_decoder_transfer() requests from a reader at once.
+ *
+ * This is the size of the lookahead in slipc_decoder_t and changes its layout,
+ * so the library and its users need the same value. The
+ * SLIPC_TRANSFER_CHUNK_SIZE CMake variable sets it for both.
+ */
+#ifndef SLIPC_TRANSFER_CHUNK_SIZE
+#define SLIPC_TRANSFER_CHUNK_SIZE 64
+#endif
+
+/**
+ * \brief Number of segments slipc_encode_packet_vec() passes to the writer at
+ * once.
+ */
+#ifndef SLIPC_ENCODER_VEC_COUNT
+#define SLIPC_ENCODER_VEC_COUNT 32
+#endif
+
 /**
  * \brief Special characters used in SLIP encoding.
  */
@@ -34,12 +56,48 @@ typedef enum slipc_char {
   SLIPC_ESC_ESC = 0xDD, /**< Escaped ESC character */
 } slipc_char_t;
 
+/**
+ * \brief Largest possible encoded size of len bytes.
+ *
+ * Every byte may need escaping, plus the END byte and the optional start byte.
+ * This is a constant expression if its arguments are.
+ */
+#define SLIPC_ENCODED_SIZE_MAX(len, startbyte)                                 \
+  (2 * (size_t)(len) + 1 + ((startbyte) ? 1 : 0))
+
+/**
+ * \brief Encoder statistics, counted by slipc_encoder_transfer() and
+ * slipc_encoder_write().
+ */
+typedef struct slipc_encoder_stats {
+  size_t frames;   /**< Frames encoded */
+  size_t bytes_in; /**< Bytes read from the reader */
+  size_t escapes;  /**< Escape sequences written */
+#if SLIPC_ENABLE_TRACE
+  slipc_trace_t trace; /**< Trace of slipc_encoder_transfer() */
+#endif
+} slipc_encoder_stats_t;
+
 /**
  * \struct slipc_encoder
  * \brief Encoder structure.
  */
 typedef struct slipc_encoder {
-  bool startbyte; /**< Indicates if the start byte should be used */
+  bool startbyte;              /**< Write a start byte before each frame */
+  slipc_encoder_stats_t stats; /**< Statistics, zeroed on init */
+  bool in_frame;               /**< Start byte written, frame not finished */
+  uint8_t pending;             /**< Second byte of a split escape, or 0 */
+  bool reader_eof;             /**< Chunk holds the reader's last bytes */
+  uint8_t byte;                /**< Chunk without a chunk buffer */
+  size_t pos;                  /**< Bytes of the packet or chunk encoded */
+  size_t chunk_len;            /**< Number of bytes in the chunk */
+  uint8_t *chunk;              /**< Chunk buffer, or NULL */
+  size_t chunk_size;           /**< Size of the chunk buffer */
+  slipc_crc_kind_t crc_kind;   /**< Checksum appended to each frame */
+  uint32_t crc;                /**< Checksum register of the current frame */
+  uint8_t trailer[SLIPC_CRC_SIZE_MAX]; /**< Checksum of the current frame */
+  uint8_t trailer_len; /**< Checksum bytes, 0 until the payload is encoded */
+  uint8_t trailer_pos; /**< Checksum bytes encoded */
 } slipc_encoder_t;
 
 /**
@@ -49,6 +107,7 @@ typedef struct slipc_encoder {
 typedef enum slipc_encoder_result {
   SLIPC_ENCODER_OK,       /**< Operation successful */
   SLIPC_ENCODER_IO_ERROR, /**< I/O error occurred */
+  SLIPC_ENCODER_AGAIN,    /**< Reader or writer would block, call again */
 } slipc_encoder_result_t;
 
 /**
@@ -65,6 +124,33 @@ void slipc_encoder_init(slipc_encoder_t *self, bool startbyte);
  */
 slipc_encoder_t slipc_encoder_new(bool startbyte);
 
+/**
+ * \brief Give the encoder a buffer for slipc_encoder_transfer().
+ *
+ * The transfer reads up to size bytes at a time into the buffer and keeps
+ * the bytes it could not write yet there. Without a buffer it reads a single
+ * byte at a time, so encoders that never transfer stay small.
+ *
+ * \param self Pointer to the encoder structure, not inside a frame
+ * \param buf Chunk buffer, needs to be alive as long as the encoder is used,
+ *            or NULL to read single bytes
+ * \param size Size of the chunk buffer
+ */
+void slipc_encoder_set_chunk(slipc_encoder_t *self, uint8_t *buf,
+                             size_t size);
+
+/**
+ * \brief Set the checksum appended to each frame.
+ *
+ * slipc_encoder_transfer() and slipc_encoder_write() run the payload through
+ * the checksum as it is written and append it escaped in front of the END
+ * byte, like slipc_encode_packet_crc(). Resumes keep the checksum.
+ *
+ * \param self Pointer to the encoder structure, not inside a frame
+ * \param kind Checksum, SLIPC_CRC_NONE to append none
+ */
+void slipc_encoder_set_crc(slipc_encoder_t *self, slipc_crc_kind_t kind);
+
 /**
  * \brief Encode a single byte into a writer.
  * \param writer Pointer to the writer structure
@@ -82,17 +168,47 @@ slipc_encoder_result_t slipc_encode_byte(slipc_io_writer_t *writer,
  * This function encodes until reader returns SLIPC_READER_EOF or an error
  * occurs while reading or writing.
  *
+ * The reader is asked for as many bytes as fit into the chunk buffer set by
+ * slipc_encoder_set_chunk(), or for single bytes without one. Every run of
+ * bytes that needs no escaping is passed to the writer in a single call.
+ *
+ * The encoder keeps its place in the frame if the writer takes less than
+ * asked for, returns SLIPC_IO_WRITER_AGAIN or the reader returns
+ * SLIPC_IO_READER_AGAIN. Call again with the same reader to continue, half
+ * written escape sequences included.
+ *
  * \param self Pointer to the encoder structure
  * \param reader Pointer to the reader structure
  * \param writer Pointer to the writer structure
  *
  * \retval SLIPC_ENCODER_OK Operation successful
  * \retval SLIPC_ENCODER_IO_ERROR I/O error occurred
+ * \retval SLIPC_ENCODER_AGAIN Frame incomplete, call again to continue
  */
 slipc_encoder_result_t slipc_encoder_transfer(slipc_encoder_t *self,
                                               slipc_io_reader_t *reader,
                                               slipc_io_writer_t *writer);
 
+/**
+ * \brief Encode a packet of data into a writer, resumable.
+ *
+ * Like slipc_encoder_transfer() from a buffer. If the frame is incomplete,
+ * the encoder remembers how far it got, so a non-blocking caller retries
+ * with the same encoder and packet once the writer can take more data.
+ *
+ * \param self Pointer to the encoder structure
+ * \param writer Pointer to the writer structure
+ * \param buf Pointer to the data buffer, unchanged until the frame is done
+ * \param len Length of the data buffer
+ *
+ * \retval SLIPC_ENCODER_OK Frame written completely
+ * \retval SLIPC_ENCODER_IO_ERROR I/O error occurred, place is kept
+ * \retval SLIPC_ENCODER_AGAIN Frame incomplete, call again to continue
+ */
+slipc_encoder_result_t slipc_encoder_write(slipc_encoder_t *self,
+                                           slipc_io_writer_t *writer,
+                                           const uint8_t *buf, size_t len);
+
 /**
  * \brief Encode a packet of data into a writer.
  *
@@ -110,13 +226,144 @@ slipc_encoder_result_t slipc_encode_packet(slipc_io_writer_t *writer,
                                            const uint8_t *buf, size_t len,
                                            bool startbyte);
 
+/**
+ * \brief Encode a packet of data into a writer, with a start byte.
+ *
+ * Same as slipc_encode_packet() with startbyte fixed at compile time.
+ */
+slipc_encoder_result_t slipc_encode_packet_sb(slipc_io_writer_t *writer,
+                                              const uint8_t *buf, size_t len);
+
+/**
+ * \brief Encode a packet of data into a writer, without a start byte.
+ *
+ * Same as slipc_encode_packet() with startbyte fixed at compile time.
+ */
+slipc_encoder_result_t slipc_encode_packet_nosb(slipc_io_writer_t *writer,
+                                                const uint8_t *buf,
+                                                size_t len);
+
+/**
+ * \brief Encode a packet of data with a checksum into a writer.
+ *
+ * The checksum is computed on every run of bytes right before it is written,
+ * then appended escaped in front of the END byte.
+ *
+ * \param writer Pointer to the writer structure
+ * \param buf Pointer to the data buffer
+ * \param len Length of the data buffer
+ * \param startbyte Indicates if the start byte should be used
+ * \param kind Checksum to append
+ *
+ * \retval SLIPC_ENCODER_OK Operation successful
+ * \retval SLIPC_ENCODER_IO_ERROR I/O error occurred
+ */
+slipc_encoder_result_t slipc_encode_packet_crc(slipc_io_writer_t *writer,
+                                               const uint8_t *buf, size_t len,
+                                               bool startbyte,
+                                               slipc_crc_kind_t kind);
+
+/**
+ * \brief Encode a packet of data into a vectored writer.
+ *
+ * The payload is not copied, the segments point into buf for every run that
+ * needs no escaping and to static data for escape sequences and END bytes.
+ * The segments are collected on the stack and passed to the writer in batches
+ * of SLIPC_ENCODER_VEC_COUNT.
+ *
+ * \param writer Pointer to the vectored writer structure
+ * \param buf Pointer to the data buffer, needs to be alive until the writer
+ *            is done with the segments
+ * \param len Length of the data buffer
+ * \param startbyte Indicates if the start byte should be used
+ *
+ * \retval SLIPC_ENCODER_OK Operation successful
+ * \retval SLIPC_ENCODER_IO_ERROR I/O error occurred
+ */
+slipc_encoder_result_t slipc_encode_packet_vec(slipc_io_vec_writer_t *writer,
+                                               const uint8_t *buf, size_t len,
+                                               bool startbyte);
+
+/**
+ * \brief Calculate the exact encoded size of a packet.
+ *
+ * \param buf Pointer to the data buffer
+ * \param len Length of the data buffer
+ * \param startbyte Indicates if the start byte should be used
+ *
+ * \return Number of bytes slipc_encode_packet() writes for this packet
+ */
+size_t slipc_encoded_size(const uint8_t *buf, size_t len, bool startbyte);
+
+/**
+ * \brief Encode many packets back to back into one buffer.
+ *
+ * Meant for many small frames sent through one write or DMA transfer. The
+ * output is the same as slipc_encode_packet() of each packet in turn, so
+ * with startbyte every packet gets its own start byte and decoders expecting
+ * start bytes find every frame.
+ *
+ * Encoding stops at the first packet that does not fit into the rest of the
+ * output buffer.
+ *
+ * \param out Pointer to the output buffer
+ * \param len Pointer to the size of the output buffer, set to the number of
+ *            bytes written
+ * \param frames Pointer to the packets
+ * \param count Pointer to the number of packets, set to the number of
+ *              packets encoded
+ * \param offsets Array of count offsets, each set to the offset past the END
+ *                byte of its packet, may be NULL
+ * \param startbyte Indicates if the start byte should be used
+ *
+ * \retval SLIPC_ENCODER_OK All packets encoded
+ * \retval SLIPC_ENCODER_AGAIN Output buffer full, pass the rest to the next
+ *                             call
+ */
+slipc_encoder_result_t slipc_encode_frames(uint8_t *out, size_t *len,
+                                           const slipc_io_vec_t *frames,
+                                           size_t *count, size_t *offsets,
+                                           bool startbyte);
+
+/**
+ * \brief Decoder statistics.
+ *
+ * Counted once per decoded run, so they cost next to nothing. Not counted by
+ * slipc_decode_byte().
+ */
+typedef struct slipc_decoder_stats {
+  size_t frames;          /**< Frames completed, including dropped ones */
+  size_t bytes_in;        /**< Bytes consumed */
+  size_t bytes_out;       /**< Bytes decoded */
+  size_t invalid_escapes; /**< ESC followed by an invalid byte */
+  size_t skipped;         /**< Bytes skipped while looking for a start byte */
+  size_t oversize;        /**< Frames dropped for exceeding max_len */
+  size_t empty;           /**< Frames without any data */
+  size_t crc_errors;      /**< Frames failing the checksum */
+#if SLIPC_ENABLE_TRACE
+  slipc_trace_t trace; /**< Trace of slipc_decoder_transfer() */
+#endif
+} slipc_decoder_stats_t;
+
 /**
  * \brief Decoder structure.
  */
 typedef struct slipc_decoder {
-  bool startbyte; /**< Indicates if the start byte should be used */
-  uint8_t prev;   /**< Previous byte processed */
-  bool malformed; /**< Malformed packet */
+  bool startbyte;              /**< Expect a start byte before each frame */
+  uint8_t prev;                /**< Previous byte processed */
+  bool malformed;              /**< Malformed packet */
+  bool in_frame;               /**< Inside a frame, for feed and resume */
+  bool oversize;               /**< Frame exceeded max_len */
+  size_t max_len;              /**< Maximum frame length, 0 for no limit */
+  size_t frame_len;            /**< Bytes decoded from the current frame */
+  slipc_crc_kind_t crc_kind;   /**< Checksum expected at the end of frames */
+  uint32_t crc;                /**< Checksum register of the current frame */
+  slipc_decoder_stats_t stats; /**< Statistics, zeroed on init */
+  bool reader_eof;             /**< Lookahead holds the reader's last chunk */
+  size_t lookahead_pos;        /**< Start of the bytes left in the lookahead */
+  size_t lookahead_len;        /**< Number of bytes left in the lookahead */
+  /** Bytes read by slipc_decoder_transfer() but not yet decoded */
+  uint8_t lookahead[SLIPC_TRANSFER_CHUNK_SIZE];
 } slipc_decoder_t;
 
 /**
@@ -127,6 +374,8 @@ typedef enum slipc_decoder_result {
   SLIPC_DECODER_MORE,      /**< More data available */
   SLIPC_DECODER_NOT_FOUND, /**< Data not found */
   SLIPC_DECODER_IO_ERROR,  /**< I/O error occurred */
+  SLIPC_DECODER_AGAIN,     /**< Reader would block, call again later */
+  SLIPC_DECODER_CRC_ERROR, /**< End of packet, but the checksum is wrong */
 } slipc_decoder_result_t;
 
 /**
@@ -148,6 +397,38 @@ slipc_decoder_t slipc_decoder_new(bool startbyte);
  */
 bool slipc_decoder_is_malformed(slipc_decoder_t *self);
 
+/**
+ * \brief Set the maximum frame length.
+ *
+ * Once a frame decodes to more than max_len bytes, the decoder stops writing,
+ * marks the frame oversize and skips to the next END byte. The frame still
+ * ends with SLIPC_DECODER_EOF, check slipc_decoder_is_oversize() to drop it.
+ * Not enforced by slipc_decode_byte().
+ *
+ * \param self Pointer to the decoder structure
+ * \param max_len Maximum frame length, 0 for no limit
+ */
+void slipc_decoder_set_max_len(slipc_decoder_t *self, size_t max_len);
+
+/**
+ * \brief Check if the current packet exceeded the maximum frame length.
+ */
+bool slipc_decoder_is_oversize(slipc_decoder_t *self);
+
+/**
+ * \brief Set the checksum expected at the end of each frame.
+ *
+ * The checksum is computed over the decoded bytes while they are written.
+ * A complete frame with a wrong checksum ends with SLIPC_DECODER_CRC_ERROR
+ * instead of SLIPC_DECODER_EOF. The checksum bytes are part of the output,
+ * drop the last slipc_crc_size() bytes of a frame. Empty and oversize frames
+ * are not checked. Not checked by slipc_decode_byte().
+ *
+ * \param self Pointer to the decoder structure
+ * \param kind Checksum, SLIPC_CRC_NONE to stop checking
+ */
+void slipc_decoder_set_crc(slipc_decoder_t *self, slipc_crc_kind_t kind);
+
 /**
  * \brief Decode a single byte into a writer.
  *
@@ -179,6 +460,14 @@ slipc_decoder_result_t slipc_decode_byte(slipc_decoder_t *self,
  * This function decodes until reader returns SLIPC_READER_EOF or an error
  * occurs while reading or writing.
  *
+ * The reader is asked for up to SLIPC_TRANSFER_CHUNK_SIZE bytes at a time.
+ * Bytes read past the end of a packet are kept in the decoder and used by the
+ * next call, so a decoder must stay with its reader.
+ *
+ * If a non-blocking reader returns SLIPC_IO_READER_AGAIN, the decoder keeps
+ * its state and the next call resumes the packet. The writer is expected to
+ * take all data, a writer returning SLIPC_IO_WRITER_AGAIN is an I/O error.
+ *
  * \param self Pointer to the decoder structure
  * \param reader Pointer to the reader structure
  * \param writer Pointer to the writer structure
@@ -187,11 +476,32 @@ slipc_decoder_result_t slipc_decode_byte(slipc_decoder_t *self,
  * \retval SLIPC_DECODER_MORE Packet incomplete
  * \retval SLIPC_DECODER_NOT_FOUND No Start byte found (if startbyte is true)
  * \retval SLIPC_DECODER_IO_ERROR I/O error occurred
+ * \retval SLIPC_DECODER_AGAIN Reader would block, call again to resume
  */
 slipc_decoder_result_t slipc_decoder_transfer(slipc_decoder_t *self,
                                               slipc_io_reader_t *reader,
                                               slipc_io_writer_t *writer);
 
+/**
+ * \brief Transfer data from reader to writer, expecting a start byte.
+ *
+ * Same as slipc_decoder_transfer() but ignores the startbyte option of the
+ * decoder, so the check is resolved at compile time.
+ */
+slipc_decoder_result_t slipc_decoder_transfer_sb(slipc_decoder_t *self,
+                                                 slipc_io_reader_t *reader,
+                                                 slipc_io_writer_t *writer);
+
+/**
+ * \brief Transfer data from reader to writer, without a start byte.
+ *
+ * Same as slipc_decoder_transfer() but ignores the startbyte option of the
+ * decoder, so the check is resolved at compile time.
+ */
+slipc_decoder_result_t slipc_decoder_transfer_nosb(slipc_decoder_t *self,
+                                                   slipc_io_reader_t *reader,
+                                                   slipc_io_writer_t *writer);
+
 /**
  * \brief Decode a packet of data into a writer.
  *
@@ -212,6 +522,147 @@ slipc_decoder_result_t slipc_decoder_decode_packet(slipc_decoder_t *self,
                                                    const uint8_t *buf,
                                                    size_t len);
 
+/**
+ * \brief Decode a packet from a buffer, expecting a start byte.
+ *
+ * Same as slipc_decoder_decode_packet() but ignores the startbyte option of
+ * the decoder, so the check is resolved at compile time.
+ */
+slipc_decoder_result_t slipc_decoder_decode_packet_sb(slipc_decoder_t *self,
+                                                      slipc_io_writer_t *writer,
+                                                      const uint8_t *buf,
+                                                      size_t len);
+
+/**
+ * \brief Decode a packet from a buffer, without a start byte.
+ *
+ * Same as slipc_decoder_decode_packet() but ignores the startbyte option of
+ * the decoder, so the check is resolved at compile time.
+ */
+slipc_decoder_result_t
+slipc_decoder_decode_packet_nosb(slipc_decoder_t *self,
+                                 slipc_io_writer_t *writer, const uint8_t *buf,
+                                 size_t len);
+
+/**
+ * \brief Decode a packet of data in place.
+ *
+ * This is identical to decode packet, but the decoded data is written to the
+ * front of the input buffer instead of a writer. Decoded data is never longer
+ * than its encoded form, so no extra buffer is needed.
+ *
+ * \param self Pointer to the decoder structure
+ * \param buf Pointer to the data buffer
+ * \param len Pointer to the length of the data buffer, set to the number of
+ *            bytes consumed
+ * \param out_len Pointer to the decoded length
+ *
+ * \retval SLIPC_DECODER_EOF Packet transfer complete
+ * \retval SLIPC_DECODER_MORE Packet incomplete
+ * \retval SLIPC_DECODER_NOT_FOUND No Start byte found (if startbyte is true)
+ */
+slipc_decoder_result_t slipc_decoder_decode_packet_in_place(
+    slipc_decoder_t *self, uint8_t *buf, size_t *len, size_t *out_len);
+
+/**
+ * \brief Decode a chunk of data into a memory buffer.
+ *
+ * This is the incremental, buffer based counterpart of transfer. It can be
+ * called with consecutive chunks of a stream, e.g. the results of read(), and
+ * keeps all state needed to continue in the decoder structure.
+ *
+ * Decoding stops after the SLIP_END byte of a frame, when the input is
+ * consumed or when the output buffer is full, whatever comes first. The
+ * remaining input can be passed to the next call.
+ *
+ * If startbyte is true, data before the start byte of a frame is skipped.
+ * The malformed state is reset at the start of every frame.
+ *
+ * The output buffer may be the input buffer to decode in place.
+ *
+ * \param self Pointer to the decoder structure
+ * \param in Pointer to the input data
+ * \param in_len Pointer to the length of the input, set to the number of
+ *               bytes consumed
+ * \param out Pointer to the output buffer
+ * \param out_len Pointer to the length of the output buffer, set to the number
+ *                of bytes written
+ *
+ * \retval SLIPC_DECODER_EOF Frame complete
+ * \retval SLIPC_DECODER_MORE Frame incomplete, input consumed or output full
+ * \retval SLIPC_DECODER_NOT_FOUND No Start byte found (if startbyte is true)
+ */
+slipc_decoder_result_t slipc_decoder_feed(slipc_decoder_t *self,
+                                          uint8_t const *in, size_t *in_len,
+                                          uint8_t *out, size_t *out_len);
+
+/**
+ * \brief Decode a chunk of data, expecting a start byte.
+ *
+ * Same as slipc_decoder_feed() but ignores the startbyte option of the
+ * decoder, so the check is resolved at compile time.
+ */
+slipc_decoder_result_t slipc_decoder_feed_sb(slipc_decoder_t *self,
+                                             uint8_t const *in, size_t *in_len,
+                                             uint8_t *out, size_t *out_len);
+
+/**
+ * \brief Decode a chunk of data, without a start byte.
+ *
+ * Same as slipc_decoder_feed() but ignores the startbyte option of the
+ * decoder, so the check is resolved at compile time.
+ */
+slipc_decoder_result_t slipc_decoder_feed_nosb(slipc_decoder_t *self,
+                                               uint8_t const *in,
+                                               size_t *in_len, uint8_t *out,
+                                               size_t *out_len);
+
+/**
+ * \brief Descriptor of a decoded frame.
+ */
+typedef struct slipc_frame_desc {
+  size_t offset;  /**< Offset of the decoded frame in the output buffer */
+  size_t len;     /**< Length of the decoded frame */
+  bool malformed; /**< Frame is malformed */
+  bool crc_error; /**< Frame failed the checksum */
+  bool oversize;  /**< Frame truncated, exceeded max_len or the output */
+} slipc_frame_desc_t;
+
+/**
+ * \brief Decode all complete frames of a buffer in one pass.
+ *
+ * The frames are decoded back to back into the output buffer and described
+ * by the frames array.
+ *
+ * Decoding stops when the frames array or the output buffer is full or when
+ * no complete frame is left. An incomplete frame at the end of the input is
+ * not consumed, so it can be passed again once more data has arrived.
+ * A frame that does not fit into the remaining output is not consumed either
+ * and waits for the next call. If it does not fit into the whole output, it
+ * never will: it is truncated to the output length and skipped to its END,
+ * marked oversize like a frame exceeding max_len, so a caller calling again
+ * on SLIPC_DECODER_EOF always makes progress.
+ *
+ * The output buffer may be the input buffer to decode in place.
+ *
+ * \param self Pointer to the decoder structure
+ * \param buf Pointer to the input data
+ * \param len Pointer to the length of the input, set to the number of bytes
+ *            consumed
+ * \param out Pointer to the output buffer
+ * \param out_len Length of the output buffer
+ * \param frames Pointer to the frame descriptors
+ * \param frame_count Pointer to the number of frame descriptors, set to the
+ *                    number of frames decoded
+ *
+ * \retval SLIPC_DECODER_EOF Frames or output full, more frames may follow
+ * \retval SLIPC_DECODER_MORE No complete frame left in the input
+ */
+slipc_decoder_result_t
+slipc_decoder_decode_frames(slipc_decoder_t *self, uint8_t const *buf,
+                            size_t *len, uint8_t *out, size_t out_len,
+                            slipc_frame_desc_t *frames, size_t *frame_count);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,224 @@
+/**
+ * \file slipc.hpp
+ * \brief SLIPC C++20 encode and decode on spans and iterators.
+ *
+ * Header only, follows the same escape rules as slipc_encode_byte() and
+ * slipc_decode_byte(). Output goes straight to an output iterator or span,
+ * without a slipc_io_writer_t in between, so the loops inline completely.
+ *
+ * LICENSE: This library is released under the MIT License.
+ */
+#ifndef _SLIPC_HPP_
+#define _SLIPC_HPP_
+
+#include "slipc.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <span>
+
+namespace slipc {
+
+inline constexpr std::uint8_t end = SLIPC_END;         /**< END byte */
+inline constexpr std::uint8_t esc = SLIPC_ESC;         /**< ESC byte */
+inline constexpr std::uint8_t esc_end = SLIPC_ESC_END; /**< Escaped END */
+inline constexpr std::uint8_t esc_esc = SLIPC_ESC_ESC; /**< Escaped ESC */
+
+/**
+ * \brief Result codes for decoding, same meaning as slipc_decoder_result_t.
+ */
+enum class decode_status {
+  eof,       /**< End of packet reached */
+  more,      /**< Input consumed or output full without end of packet */
+  not_found, /**< No packet found */
+};
+
+/**
+ * \brief Result of decoding a packet.
+ */
+template <typename Out> struct decode_result {
+  Out out;              /**< Output iterator past the last decoded byte */
+  std::size_t consumed; /**< Number of input bytes consumed */
+  decode_status status; /**< Result code */
+  bool malformed;       /**< Packet contained invalid escapes */
+};
+
+namespace detail {
+
+constexpr bool is_special(std::uint8_t byte) {
+  return byte == end || byte == esc;
+}
+
+template <std::output_iterator<std::uint8_t> Out>
+constexpr decode_result<Out> decode(std::span<std::uint8_t const> in, Out out,
+                                    std::size_t limit, bool startbyte) {
+  std::size_t i = 0;
+
+  if (startbyte) {
+    auto start = std::ranges::find(in, end);
+    if (start == in.end()) {
+      return {out, in.size(), decode_status::not_found, false};
+    }
+    i = static_cast<std::size_t>(start - in.begin()) + 1;
+  }
+
+  if (i == in.size()) {
+    return {out, i, decode_status::not_found, false};
+  }
+
+  bool malformed = false;
+  bool escaped = false;
+
+  for (; i < in.size(); i++) {
+    std::uint8_t byte = in[i];
+
+    if (byte == end) {
+      return {out, i + 1, decode_status::eof, malformed};
+    }
+
+    if (escaped) {
+      if (limit == 0) {
+        break;
+      }
+      if (byte == esc_end) {
+        byte = end;
+      } else if (byte == esc_esc) {
+        byte = esc;
+      } else {
+        // Malformed packet, but let's just keep those bytes in the output.
+        malformed = true;
+      }
+      *out++ = byte;
+      limit--;
+      // Like slipc_decode_byte(), an ESC written as is escapes the next byte.
+      escaped = in[i] == esc;
+      continue;
+    }
+
+    if (byte == esc) {
+      escaped = true;
+      continue;
+    }
+
+    if (limit == 0) {
+      break;
+    }
+    *out++ = byte;
+    limit--;
+  }
+
+  // Leave a pending ESC unconsumed, a resume at consumed keeps the escape.
+  return {out, escaped ? i - 1 : i, decode_status::more, malformed};
+}
+
+} // namespace detail
+
+/**
+ * \brief Exact encoded size of a packet.
+ *
+ * \param in Data of the packet
+ * \param startbyte Indicates if the start byte should be used
+ *
+ * \return Number of bytes encode() writes for this packet
+ */
+constexpr std::size_t encoded_size(std::span<std::uint8_t const> in,
+                                   bool startbyte = false) {
+  auto const special =
+      static_cast<std::size_t>(std::ranges::count_if(in, detail::is_special));
+  return in.size() + special + 1 + (startbyte ? 1 : 0);
+}
+
+/**
+ * \brief Encode a packet into an output iterator.
+ *
+ * \param in Data of the packet
+ * \param out Output iterator, needs room for encoded_size() bytes
+ * \param startbyte Indicates if the start byte should be used
+ *
+ * \return Output iterator past the END byte
+ */
+template <std::output_iterator<std::uint8_t> Out>
+constexpr Out encode(std::span<std::uint8_t const> in, Out out,
+                     bool startbyte = false) {
+  if (startbyte) {
+    *out++ = end;
+  }
+
+  auto it = in.begin();
+  while (it != in.end()) {
+    auto run = std::find_if(it, in.end(), detail::is_special);
+    out = std::copy(it, run, out);
+    if (run == in.end()) {
+      break;
+    }
+
+    *out++ = esc;
+    *out++ = *run == end ? esc_end : esc_esc;
+    it = run + 1;
+  }
+
+  *out++ = end;
+  return out;
+}
+
+/**
+ * \brief Encode a packet into a span.
+ *
+ * \param in Data of the packet
+ * \param out Output buffer
+ * \param startbyte Indicates if the start byte should be used
+ *
+ * \return Number of bytes written, 0 if the packet does not fit
+ */
+constexpr std::size_t encode(std::span<std::uint8_t const> in,
+                             std::span<std::uint8_t> out,
+                             bool startbyte = false) {
+  if (out.size() < SLIPC_ENCODED_SIZE_MAX(in.size(), startbyte) &&
+      out.size() < encoded_size(in, startbyte)) {
+    return 0;
+  }
+  return static_cast<std::size_t>(encode(in, out.begin(), startbyte) -
+                                  out.begin());
+}
+
+/**
+ * \brief Decode a single packet into an output iterator.
+ *
+ * Same results as slipc_decoder_decode_packet() on a fresh decoder.
+ *
+ * \param in Encoded data
+ * \param out Output iterator, needs room for in.size() bytes
+ * \param startbyte Indicates if a start byte is expected
+ *
+ * \return Output iterator, consumed bytes and result code
+ */
+template <std::output_iterator<std::uint8_t> Out>
+constexpr decode_result<Out> decode(std::span<std::uint8_t const> in, Out out,
+                                    bool startbyte = false) {
+  return detail::decode(in, out, std::numeric_limits<std::size_t>::max(),
+                        startbyte);
+}
+
+/**
+ * \brief Decode a single packet into a span.
+ *
+ * Stops with decode_status::more once the output is full.
+ *
+ * \param in Encoded data
+ * \param out Output buffer
+ * \param startbyte Indicates if a start byte is expected
+ *
+ * \return Output iterator, consumed bytes and result code
+ */
+constexpr decode_result<std::span<std::uint8_t>::iterator>
+decode(std::span<std::uint8_t const> in, std::span<std::uint8_t> out,
+       bool startbyte = false) {
+  return detail::decode(in, out.begin(), out.size(), startbyte);
+}
+
+} // namespace slipc
+
+#endif /* _SLIPC_HPP_ */
@@ -0,0 +1,334 @@
+/**
+ * \file slipc_async.hpp
+ * \brief SLIPC C++20 coroutine framed streams.
+ *
+ * Reads frames from and writes frames to asynchronous byte streams, so many
+ * endpoints can be served from one event loop instead of one thread each.
+ *
+ * The event loop is pluggable: a reader is any type with
+ * `read(std::span<std::uint8_t>)` and a writer any type with
+ * `write(std::span<const std::uint8_t>)`, both returning an awaitable that
+ * yields the number of bytes transferred, 0 meaning the stream is closed.
+ * Suspend in those awaitables until epoll, io_uring or similar reports the
+ * descriptor ready.
+ *
+ * Decoding runs on slipc_decoder_feed(), so link against slipc.
+ *
+ * LICENSE: This library is released under the MIT License.
+ */
+#ifndef _SLIPC_ASYNC_HPP_
+#define _SLIPC_ASYNC_HPP_
+
+#include "slipc.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <optional>
+#include <span>
+#include <utility>
+
+namespace slipc {
+
+namespace detail {
+
+/**
+ * \brief Resumes whoever awaits a finished coroutine.
+ */
+struct continuation_awaiter {
+  bool await_ready() noexcept { return false; }
+
+  template <typename Promise>
+  std::coroutine_handle<>
+  await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+    auto next = handle.promise().continuation;
+    return next ? next : std::noop_coroutine();
+  }
+
+  void await_resume() noexcept {}
+};
+
+} // namespace detail
+
+/**
+ * \brief Lazily started coroutine returning a value.
+ *
+ * Runs when awaited, or when start() is called from outside a coroutine.
+ */
+template <typename T> class task {
+public:
+  struct promise_type {
+    std::coroutine_handle<> continuation; /**< Coroutine awaiting the task */
+    std::optional<T> value;               /**< Returned value */
+    std::exception_ptr error;             /**< Escaped exception */
+
+    task get_return_object() {
+      return task{std::coroutine_handle<promise_type>::from_promise(*this)};
+    }
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    detail::continuation_awaiter final_suspend() noexcept { return {}; }
+    void return_value(T result) { value.emplace(std::move(result)); }
+    void unhandled_exception() { error = std::current_exception(); }
+  };
+
+  task(task &&other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+  task(task const &) = delete;
+  task &operator=(task const &) = delete;
+  ~task() {
+    if (handle_) {
+      handle_.destroy();
+    }
+  }
+
+  /** \brief Run the task until its first suspension. */
+  void start() { handle_.resume(); }
+
+  /** \brief Check if the task has finished. */
+  bool done() const { return handle_.done(); }
+
+  /** \brief Result of a finished task. */
+  T &result() {
+    if (handle_.promise().error) {
+      std::rethrow_exception(handle_.promise().error);
+    }
+    return *handle_.promise().value;
+  }
+
+  auto operator co_await() noexcept {
+    struct awaiter {
+      std::coroutine_handle<promise_type> handle;
+
+      bool await_ready() noexcept { return handle.done(); }
+      std::coroutine_handle<>
+      await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle.promise().continuation = awaiting;
+        return handle;
+      }
+      T await_resume() {
+        if (handle.promise().error) {
+          std::rethrow_exception(handle.promise().error);
+        }
+        return std::move(*handle.promise().value);
+      }
+    };
+    return awaiter{handle_};
+  }
+
+private:
+  explicit task(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+  std::coroutine_handle<promise_type> handle_;
+};
+
+/**
+ * \brief Coroutine producing values with co_yield while awaiting I/O.
+ *
+ * Each yielded value is valid until the consumer awaits next() again.
+ */
+template <typename T> class async_generator {
+public:
+  struct promise_type {
+    std::coroutine_handle<> continuation; /**< Consumer awaiting next() */
+    T const *current = nullptr;           /**< Last yielded value */
+    std::exception_ptr error;             /**< Escaped exception */
+
+    async_generator get_return_object() {
+      return async_generator{
+          std::coroutine_handle<promise_type>::from_promise(*this)};
+    }
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    detail::continuation_awaiter final_suspend() noexcept { return {}; }
+    detail::continuation_awaiter yield_value(T const &value) noexcept {
+      current = &value;
+      return {};
+    }
+    void return_void() noexcept { current = nullptr; }
+    void unhandled_exception() {
+      current = nullptr;
+      error = std::current_exception();
+    }
+  };
+
+  async_generator(async_generator &&other) noexcept
+      : handle_(std::exchange(other.handle_, {})) {}
+  async_generator(async_generator const &) = delete;
+  async_generator &operator=(async_generator const &) = delete;
+  ~async_generator() {
+    if (handle_) {
+      handle_.destroy();
+    }
+  }
+
+  /**
+   * \brief Await the next value.
+   *
+   * \return Pointer to the value, nullptr once the generator is finished
+   */
+  auto next() noexcept {
+    struct awaiter {
+      std::coroutine_handle<promise_type> handle;
+
+      bool await_ready() noexcept { return handle.done(); }
+      std::coroutine_handle<>
+      await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle.promise().continuation = awaiting;
+        return handle;
+      }
+      T const *await_resume() {
+        if (handle.promise().error) {
+          std::rethrow_exception(handle.promise().error);
+        }
+        return handle.done() ? nullptr : handle.promise().current;
+      }
+    };
+    return awaiter{handle_};
+  }
+
+private:
+  explicit async_generator(std::coroutine_handle<promise_type> handle)
+      : handle_(handle) {}
+
+  std::coroutine_handle<promise_type> handle_;
+};
+
+/**
+ * \brief Decoded frame, points into the frame buffer of read_frames().
+ */
+struct frame {
+  std::span<std::uint8_t const> data; /**< Decoded data */
+  bool malformed;                     /**< Frame contained invalid escapes */
+};
+
+/**
+ * \brief Read frames from an asynchronous reader.
+ *
+ * Frames longer than the frame buffer are dropped.
+ *
+ * \param reader Asynchronous reader, needs to outlive the generator
+ * \param startbyte Indicates if a start byte is expected
+ * \param frame_buf Buffer for the decoded frame, must not be empty
+ * \param read_buf Buffer for reading, must not be empty
+ *
+ * \return Generator yielding every complete frame
+ */
+template <typename Reader>
+async_generator<frame> read_frames(Reader &reader, bool startbyte,
+                                   std::span<std::uint8_t> frame_buf,
+                                   std::span<std::uint8_t> read_buf) {
+  assert(!frame_buf.empty());
+  assert(!read_buf.empty());
+
+  slipc_decoder_t decoder = slipc_decoder_new(startbyte);
+  slipc_decoder_set_max_len(&decoder, frame_buf.size());
+  std::size_t frame_len = 0;
+
+  while (true) {
+    std::size_t len = co_await reader.read(read_buf);
+    if (len == 0) {
+      co_return;
+    }
+
+    std::uint8_t const *in = read_buf.data();
+    while (len > 0) {
+      std::size_t in_len = len;
+      std::size_t out_len = frame_buf.size() - frame_len;
+      auto res = slipc_decoder_feed(&decoder, in, &in_len,
+                                    frame_buf.data() + frame_len, &out_len);
+      in += in_len;
+      len -= in_len;
+      frame_len += out_len;
+
+      if (res == SLIPC_DECODER_EOF) {
+        if (!slipc_decoder_is_oversize(&decoder)) {
+          co_yield frame{frame_buf.first(frame_len), decoder.malformed};
+        }
+        frame_len = 0;
+      }
+    }
+  }
+}
+
+/**
+ * \brief Write all data to an asynchronous writer.
+ *
+ * \param writer Asynchronous writer
+ * \param data Data to write
+ *
+ * \return false if the writer was closed before all data was written
+ */
+template <typename Writer>
+task<bool> write_all(Writer &writer, std::span<std::uint8_t const> data) {
+  while (!data.empty()) {
+    std::size_t len = co_await writer.write(data);
+    if (len == 0) {
+      co_return false;
+    }
+    data = data.subspan(len);
+  }
+  co_return true;
+}
+
+/**
+ * \brief Encode a frame and write it to an asynchronous writer.
+ *
+ * The frame is encoded through the scratch buffer in pieces, so the scratch
+ * buffer does not need to hold the whole encoded frame.
+ *
+ * \param writer Asynchronous writer
+ * \param payload Data of the frame
+ * \param startbyte Indicates if the start byte should be used
+ * \param scratch Buffer for the encoded data, at least 2 bytes
+ *
+ * \return false if the writer was closed before the frame was written
+ */
+template <typename Writer>
+task<bool> write_frame(Writer &writer, std::span<std::uint8_t const> payload,
+                       bool startbyte, std::span<std::uint8_t> scratch) {
+  assert(scratch.size() >= 2);
+
+  std::size_t pos = 0;
+  if (startbyte) {
+    scratch[pos++] = end;
+  }
+
+  auto it = payload.begin();
+  while (it != payload.end()) {
+    if (scratch.size() - pos < 2) {
+      if (!co_await write_all(writer, scratch.first(pos))) {
+        co_return false;
+      }
+      pos = 0;
+    }
+
+    // Copy plain bytes up to the next special byte or the end of scratch.
+    auto const room = static_cast<std::ptrdiff_t>(scratch.size() - pos);
+    auto const stop = payload.end() - it > room ? it + room : payload.end();
+    auto const run = std::find_if(it, stop, detail::is_special);
+    pos += static_cast<std::size_t>(
+        std::copy(it, run, scratch.begin() + pos) - (scratch.begin() + pos));
+    it = run;
+
+    if (it != payload.end() && detail::is_special(*it) &&
+        scratch.size() - pos >= 2) {
+      scratch[pos++] = esc;
+      scratch[pos++] = *it == end ? esc_end : esc_esc;
+      ++it;
+    }
+  }
+
+  if (pos == scratch.size()) {
+    if (!co_await write_all(writer, scratch.first(pos))) {
+      co_return false;
+    }
+    pos = 0;
+  }
+  scratch[pos++] = end;
+  co_return co_await write_all(writer, scratch.first(pos));
+}
+
+} // namespace slipc
+
+#endif /* _SLIPC_ASYNC_HPP_ */
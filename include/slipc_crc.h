@@ -0,0 +1,114 @@
+/**
+ * \file slipc_crc.h
+ * \brief SLIPC frame checksums.
+ *
+ * CRC-16 and CRC-32 for checking frames, computed with slice-by-8 tables or
+ * the CRC32 instructions of ARMv8 where available.
+ *
+ * The CRC is appended to the payload, so the CRC over payload and CRC
+ * together ends in a fixed residue. This lets the decoder check a frame
+ * while decoding it, without knowing where the payload ends.
+ *
+ * LICENSE: This library is released under the MIT License.
+ */
+#ifndef _SLIPC_CRC_H_
+#define _SLIPC_CRC_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Checksum appended to each frame.
+ */
+typedef enum slipc_crc_kind {
+  SLIPC_CRC_NONE, /**< No checksum */
+  SLIPC_CRC_16,   /**< CRC-16/CCITT-FALSE, appended big endian */
+  SLIPC_CRC_32,   /**< CRC-32 as in IEEE 802.3, appended little endian */
+} slipc_crc_kind_t;
+
+/**
+ * \brief Largest number of bytes a checksum appends.
+ */
+#define SLIPC_CRC_SIZE_MAX 4
+
+/**
+ * \brief Number of bytes the checksum appends.
+ *
+ * \param kind Checksum
+ *
+ * \return Size of the checksum, 0 for SLIPC_CRC_NONE
+ */
+size_t slipc_crc_size(slipc_crc_kind_t kind);
+
+/**
+ * \brief Initial register value of a checksum.
+ *
+ * \param kind Checksum
+ *
+ * \return Register value before any data
+ */
+uint32_t slipc_crc_init(slipc_crc_kind_t kind);
+
+/**
+ * \brief Run data through a checksum register.
+ *
+ * \param kind Checksum
+ * \param crc Register value from slipc_crc_init() or a previous update
+ * \param buf Pointer to the data
+ * \param len Length of the data
+ *
+ * \return Updated register value
+ */
+uint32_t slipc_crc_update(slipc_crc_kind_t kind, uint32_t crc,
+                          const uint8_t *buf, size_t len);
+
+/**
+ * \brief Get the bytes to append to a frame.
+ *
+ * \param kind Checksum
+ * \param crc Register value after the payload
+ * \param out Buffer for the checksum, SLIPC_CRC_SIZE_MAX bytes
+ *
+ * \return Number of bytes written to out
+ */
+size_t slipc_crc_trailer(slipc_crc_kind_t kind, uint32_t crc, uint8_t *out);
+
+/**
+ * \brief Check the register after the payload and its appended checksum.
+ *
+ * \param kind Checksum
+ * \param crc Register value after payload and checksum
+ *
+ * \return true if the checksum matches
+ */
+bool slipc_crc_check(slipc_crc_kind_t kind, uint32_t crc);
+
+/**
+ * \brief CRC-16/CCITT-FALSE of a buffer.
+ *
+ * \param buf Pointer to the data
+ * \param len Length of the data
+ *
+ * \return Checksum, 0x29B1 for "123456789"
+ */
+uint16_t slipc_crc16(const uint8_t *buf, size_t len);
+
+/**
+ * \brief CRC-32 of a buffer.
+ *
+ * \param buf Pointer to the data
+ * \param len Length of the data
+ *
+ * \return Checksum, 0xCBF43926 for "123456789"
+ */
+uint32_t slipc_crc32(const uint8_t *buf, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* _SLIPC_CRC_H_ */
@@ -0,0 +1,114 @@
+/**
+ * \file slipc_framer.h
+ * \brief SLIPC framer, delivers complete frames to a callback.
+ *
+ * The framer decodes incoming chunks into a reusable frame buffer and calls
+ * the frame callback once per complete frame, instead of passing every
+ * decoded byte through a writer.
+ *
+ * LICENSE: This library is released under the MIT License.
+ */
+#ifndef _SLIPC_FRAMER_H_
+#define _SLIPC_FRAMER_H_
+
+#include "slipc.h"
+#include "slipc_io.h"
+#include "slipc_pool.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Callback function type for complete frames.
+ *
+ * If the framer draws its buffers from a pool, the callback takes ownership
+ * of the frame and gives it back with slipc_pool_release() when done.
+ *
+ * \param user_ctx User context
+ * \param frame Pointer to the decoded frame, only valid during the call
+ *              unless it is owned by a pool
+ * \param len Length of the decoded frame
+ * \param malformed Indicates if the frame is malformed
+ */
+typedef void (*slipc_framer_frame_cb)(slipc_io_user_ctx_t user_ctx,
+                                      const uint8_t *frame, size_t len,
+                                      bool malformed);
+
+/**
+ * \brief Framer structure.
+ */
+typedef struct slipc_framer {
+  slipc_decoder_t decoder;           /**< Decoder state */
+  slipc_pool_t *pool;                /**< Pool of frame buffers, or NULL */
+  uint8_t *buf;                      /**< Frame buffer */
+  size_t size;                       /**< Size of the frame buffer */
+  size_t len;                        /**< Length of the current frame */
+  bool dropping;                     /**< No buffer for the current frame */
+  struct slipc_io_user_ctx user_ctx; /**< User context */
+  slipc_framer_frame_cb on_frame;    /**< Frame callback function */
+} slipc_framer_t;
+
+/**
+ * \brief Initialize a framer.
+ *
+ * \param self Pointer to the framer structure
+ * \param startbyte Indicates if we should expect a start byte
+ * \param buf Frame buffer, needs to be alive as long as the framer is used
+ * \param size Size of the frame buffer, frames that are longer are dropped
+ * \param on_frame Frame callback function
+ * \param user_ctx User context passed to the callback
+ */
+void slipc_framer_init(slipc_framer_t *self, bool startbyte, uint8_t *buf,
+                       size_t size, slipc_framer_frame_cb on_frame,
+                       slipc_io_user_ctx_t user_ctx);
+
+/**
+ * \brief Initialize a framer that draws a buffer from a pool for every frame.
+ *
+ * Completed frames are handed to the callback without copying. While the
+ * pool is empty, incoming frames are dropped.
+ *
+ * \param self Pointer to the framer structure
+ * \param startbyte Indicates if we should expect a start byte
+ * \param pool Pool of frame buffers, frames longer than its frame size are
+ *             dropped
+ * \param on_frame Frame callback function
+ * \param user_ctx User context passed to the callback
+ */
+void slipc_framer_init_pool(slipc_framer_t *self, bool startbyte,
+                            slipc_pool_t *pool, slipc_framer_frame_cb on_frame,
+                            slipc_io_user_ctx_t user_ctx);
+
+/**
+ * \brief Release the frame buffer currently held by a pool backed framer.
+ *
+ * \param self Pointer to the framer structure
+ */
+void slipc_framer_deinit(slipc_framer_t *self);
+
+/**
+ * \brief Decode a chunk of data and deliver all frames completed by it.
+ *
+ * The chunk is always consumed completely, an incomplete frame at its end is
+ * continued by the next call.
+ *
+ * With a checksum set on the decoder by slipc_decoder_set_crc(), frames that
+ * fail it are dropped and delivered frames come without it.
+ *
+ * \param self Pointer to the framer structure
+ * \param buf Pointer to the data buffer
+ * \param len Length of the data buffer
+ *
+ * \return Number of frames delivered
+ */
+size_t slipc_framer_feed(slipc_framer_t *self, const uint8_t *buf, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* _SLIPC_FRAMER_H_ */
@@ -17,6 +17,7 @@
 extern "C" {
 #endif
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -34,6 +35,7 @@ typedef enum slipc_io_writer_result {
   SLIPC_IO_WRITER_OK,    /**< Operation successful */
   SLIPC_IO_WRITER_EOF,   /**< End of file */
   SLIPC_IO_WRITER_ERROR, /**< Error occurred */
+  SLIPC_IO_WRITER_AGAIN, /**< Would block, retry later */
 } slipc_io_writer_result_t;
 
 /**
@@ -48,6 +50,7 @@ typedef enum slipc_io_writer_result {
  * \retval SLIPC_WRITER_OK Operation successful
  * \retval SLIPC_WRITER_EOF Can't write more data
  * \retval SLIPC_WRITER_ERROR Error occurred
+ * \retval SLIPC_WRITER_AGAIN Non-blocking writer can't take more data now
  */
 typedef slipc_io_writer_result_t (*slipc_io_write_cb)(
     slipc_io_user_ctx_t user_ctx, const uint8_t *data, size_t *len);
@@ -71,6 +74,9 @@ typedef struct slipc_io_buffer_writer {
 /**
  * \brief Create a writer for writing to a buffer.
  *
+ * The writer returns SLIPC_WRITER_EOF once data does not fit anymore, filling
+ * the buffer exactly is not an error.
+ *
  * \param self Pointer to the buffer writer structure
  * \param buf Buffer needs to be alive as long as the buffer writer is used
  * \param len Length of the buffer
@@ -84,6 +90,45 @@ slipc_io_writer_result_t slipc_io_writer_write(slipc_io_writer_t *writer,
                                                const uint8_t *data,
                                                size_t *len);
 
+/**
+ * \brief Segment of data for vectored writes.
+ */
+typedef struct slipc_io_vec {
+  const uint8_t *data; /**< Pointer to the segment data */
+  size_t len;          /**< Length of the segment */
+} slipc_io_vec_t;
+
+/**
+ * \brief Callback function type for writing segments of data.
+ *
+ * \note This expected to always set count to the number of segments written
+ * completely.
+ *
+ * \param user_ctx User context
+ * \param vecs Pointer to the segments to be written
+ * \param count Pointer to the number of segments to be written
+ *
+ * \retval SLIPC_WRITER_OK Operation successful
+ * \retval SLIPC_WRITER_EOF Can't write more data
+ * \retval SLIPC_WRITER_ERROR Error occurred
+ */
+typedef slipc_io_writer_result_t (*slipc_io_write_vec_cb)(
+    slipc_io_user_ctx_t user_ctx, const slipc_io_vec_t *vecs, size_t *count);
+
+/**
+ * \brief Vectored writer structure.
+ *
+ * This maps directly to writev() or sendmsg() like interfaces.
+ */
+typedef struct slipc_io_vec_writer {
+  struct slipc_io_user_ctx user_ctx; /**< User context */
+  slipc_io_write_vec_cb write;       /**< Write callback function */
+} slipc_io_vec_writer_t;
+
+slipc_io_writer_result_t
+slipc_io_vec_writer_write(slipc_io_vec_writer_t *writer,
+                          const slipc_io_vec_t *vecs, size_t *count);
+
 /**
  * \brief Result codes for reader operations.
  */
@@ -91,6 +136,7 @@ typedef enum slipc_io_reader_result {
   SLIPC_IO_READER_EOF,   /**< End of file */
   SLIPC_IO_READER_MORE,  /**< More data available */
   SLIPC_IO_READER_ERROR, /**< Error occurred */
+  SLIPC_IO_READER_AGAIN, /**< Would block, retry later */
 } slipc_io_reader_result_t;
 
 /**
@@ -103,12 +149,16 @@ typedef enum slipc_io_reader_result {
  *
  * If an error occurs, the function should return SLIPC_READER_ERROR.
  *
+ * A non-blocking reader returns SLIPC_READER_AGAIN if no data is available
+ * yet, but may be later.
+ *
  * \param user_ctx User context
  * \param data Pointer to buffer for reading data
  * \param len Pointer to length of data to be read
  * \retval SLIPC_READER_EOF No more data available
  * \retval SLIPC_READER_MORE More data available
  * \retval SLIPC_READER_ERROR Error occurred
+ * \retval SLIPC_READER_AGAIN No data available yet
  */
 typedef slipc_io_reader_result_t (*slipc_io_read_cb)(
     slipc_io_user_ctx_t user_ctx, uint8_t *data, size_t *len);
@@ -145,6 +195,371 @@ slipc_io_reader_t slipc_io_reader_from_buffer(slipc_io_buffer_reader_t *self,
 slipc_io_reader_result_t slipc_io_reader_read(slipc_io_reader_t *reader,
                                               uint8_t *data, size_t *len);
 
+/**
+ * \brief Memory mapped files are available.
+ */
+#ifndef SLIPC_IO_MMAP
+#if defined(__unix__) || defined(__APPLE__)
+#define SLIPC_IO_MMAP 1
+#else
+#define SLIPC_IO_MMAP 0
+#endif
+#endif
+
+#if SLIPC_IO_MMAP
+/**
+ * \brief Reader for reading from a memory mapped file.
+ *
+ * map and map_len give direct access to the whole file, e.g. for
+ * slipc_decoder_decode_frames(), without going through the reader.
+ */
+typedef struct slipc_io_mmap_reader {
+  slipc_io_buffer_reader_t buffer; /**< Buffer reader over the mapping */
+  const uint8_t *map;              /**< Mapped file, NULL if not mapped */
+  size_t map_len;                  /**< Length of the mapped file */
+} slipc_io_mmap_reader_t;
+
+/**
+ * \brief Create a reader for reading from a memory mapped file.
+ *
+ * If the file can't be opened or mapped, the reader returns
+ * SLIPC_IO_READER_ERROR.
+ *
+ * \param self Pointer to the mmap reader structure
+ * \param path Path of the file
+ *
+ * \return Initialized reader structure
+ */
+slipc_io_reader_t slipc_io_reader_from_mmap(slipc_io_mmap_reader_t *self,
+                                             const char *path);
+
+/**
+ * \brief Unmap the file of a mmap reader.
+ *
+ * \param self Pointer to the mmap reader structure
+ */
+void slipc_io_mmap_reader_close(slipc_io_mmap_reader_t *self);
+
+/**
+ * \brief Writer for writing to a memory mapped file.
+ */
+typedef struct slipc_io_mmap_writer {
+  slipc_io_buffer_writer_t buffer; /**< Buffer writer over the mapping */
+  uint8_t *map;                    /**< Mapped file, NULL if not mapped */
+  size_t map_len;                  /**< Capacity of the mapped file */
+  int fd;                          /**< File descriptor */
+} slipc_io_mmap_writer_t;
+
+/**
+ * \brief Create a writer for writing to a memory mapped file.
+ *
+ * The file is created or truncated and grown to capacity. The writer returns
+ * SLIPC_IO_WRITER_EOF once data does not fit anymore, and
+ * SLIPC_IO_WRITER_ERROR if the file can't be opened or mapped.
+ *
+ * \param self Pointer to the mmap writer structure
+ * \param path Path of the file
+ * \param capacity Maximum number of bytes to write
+ *
+ * \return Initialized writer structure
+ */
+slipc_io_writer_t slipc_io_writer_from_mmap(slipc_io_mmap_writer_t *self,
+                                             const char *path,
+                                             size_t capacity);
+
+/**
+ * \brief Unmap the file of a mmap writer and cut it to the written length.
+ *
+ * \param self Pointer to the mmap writer structure
+ *
+ * \return false if the file could not be synced or cut
+ */
+bool slipc_io_mmap_writer_close(slipc_io_mmap_writer_t *self);
+#endif
+
+/**
+ * \brief File descriptor readers and writers are available.
+ */
+#ifndef SLIPC_IO_FD
+#if defined(__unix__) || defined(__APPLE__)
+#define SLIPC_IO_FD 1
+#else
+#define SLIPC_IO_FD 0
+#endif
+#endif
+
+#if SLIPC_IO_FD
+/**
+ * \brief Buffered reader for reading from a file descriptor.
+ */
+typedef struct slipc_io_fd_reader {
+  int fd;       /**< File descriptor */
+  uint8_t *buf; /**< Read buffer */
+  size_t size;  /**< Size of the read buffer */
+  size_t pos;   /**< Start of the buffered bytes */
+  size_t len;   /**< End of the buffered bytes */
+} slipc_io_fd_reader_t;
+
+/**
+ * \brief Create a reader for reading from a file descriptor.
+ *
+ * Small reads are served from the buffer, which is refilled with one read()
+ * of its full size. Reads of at least the buffer size go to the descriptor
+ * directly.
+ *
+ * The reader returns SLIPC_IO_READER_EOF once read() returns 0. If the
+ * descriptor is non-blocking and has no data, it returns
+ * SLIPC_IO_READER_AGAIN.
+ *
+ * \param self Pointer to the fd reader structure
+ * \param fd File descriptor, not closed by the reader
+ * \param buf Buffer needs to be alive as long as the fd reader is used
+ * \param size Size of the buffer, must not be 0
+ *
+ * \return Initialized reader structure
+ */
+slipc_io_reader_t slipc_io_reader_from_fd(slipc_io_fd_reader_t *self, int fd,
+                                           uint8_t *buf, size_t size);
+
+/**
+ * \brief Buffered writer for writing to a file descriptor.
+ */
+typedef struct slipc_io_fd_writer {
+  int fd;       /**< File descriptor */
+  uint8_t *buf; /**< Write buffer */
+  size_t size;  /**< Size of the write buffer */
+  size_t len;   /**< Number of buffered bytes */
+  bool open;    /**< Frame data written since END */
+} slipc_io_fd_writer_t;
+
+/**
+ * \brief Create a writer for writing to a file descriptor.
+ *
+ * Writes are collected in the buffer and written with one write() once the
+ * buffer runs full or a write ends a frame with its END byte, so an encoded
+ * frame goes out at once. A lone END, the start byte of the next frame, is kept
+ * in the buffer.
+ *
+ * If the descriptor is non-blocking and the buffer is full, the writer takes
+ * what fits and returns SLIPC_IO_WRITER_AGAIN. A frame that could not be
+ * written right away stays buffered, call slipc_io_fd_writer_flush() once
+ * the descriptor is writable again.
+ *
+ * \param self Pointer to the fd writer structure
+ * \param fd File descriptor, not closed by the writer
+ * \param buf Buffer needs to be alive as long as the fd writer is used
+ * \param size Size of the buffer, must not be 0
+ *
+ * \return Initialized writer structure
+ */
+slipc_io_writer_t slipc_io_writer_from_fd(slipc_io_fd_writer_t *self, int fd,
+                                           uint8_t *buf, size_t size);
+
+/**
+ * \brief Write the buffered bytes of a fd writer.
+ *
+ * \param self Pointer to the fd writer structure
+ *
+ * \retval SLIPC_IO_WRITER_OK Buffer is empty
+ * \retval SLIPC_IO_WRITER_AGAIN Descriptor would block, bytes left buffered
+ * \retval SLIPC_IO_WRITER_ERROR Error occurred
+ */
+slipc_io_writer_result_t slipc_io_fd_writer_flush(slipc_io_fd_writer_t *self);
+
+/**
+ * \brief Switch a file descriptor between blocking and non-blocking mode.
+ *
+ * \param fd File descriptor
+ * \param nonblocking Indicates if the descriptor should be non-blocking
+ *
+ * \return false if the mode could not be changed
+ */
+bool slipc_io_fd_set_nonblocking(int fd, bool nonblocking);
+#endif
+
+/**
+ * \brief Size of a cache line, used to keep ring indices apart.
+ */
+#ifndef SLIPC_IO_CACHE_LINE
+#define SLIPC_IO_CACHE_LINE 64
+#endif
+
+#ifdef __cplusplus
+/* C++ code only passes the ring around, the indices are accessed from C. */
+typedef size_t slipc_io_atomic_size_t;
+#else
+typedef _Atomic size_t slipc_io_atomic_size_t;
+#endif
+
+/**
+ * \brief Lock-free single producer, single consumer ring buffer.
+ *
+ * One thread (or ISR) may write while one other thread reads, without locks.
+ * Data can be accessed in place with the peek and commit functions or copied
+ * through the reader and writer created from the ring.
+ */
+typedef struct slipc_io_ring {
+  uint8_t *buf;                /**< Storage of the ring */
+  size_t size;                 /**< Size of the storage, a power of two */
+  slipc_io_atomic_size_t head; /**< Total bytes written, owned by producer */
+  uint8_t head_pad[SLIPC_IO_CACHE_LINE - sizeof(size_t)];
+  slipc_io_atomic_size_t tail; /**< Total bytes read, owned by consumer */
+  uint8_t tail_pad[SLIPC_IO_CACHE_LINE - sizeof(size_t)];
+} slipc_io_ring_t;
+
+/**
+ * \brief Initialize a ring buffer.
+ *
+ * \param self Pointer to the ring structure
+ * \param buf Buffer needs to be alive as long as the ring is used
+ * \param size Size of the buffer, needs to be a power of two
+ */
+void slipc_io_ring_init(slipc_io_ring_t *self, uint8_t *buf, size_t size);
+
+/**
+ * \brief Get the contiguous free space of the ring.
+ *
+ * Producer only. The space may be filled and then published with
+ * slipc_io_ring_write_commit().
+ *
+ * \param self Pointer to the ring structure
+ * \param len Pointer to the length of the free space
+ *
+ * \return Pointer to the free space
+ */
+uint8_t *slipc_io_ring_write_peek(slipc_io_ring_t *self, size_t *len);
+
+/**
+ * \brief Publish len bytes written to the space from the write peek.
+ *
+ * \param self Pointer to the ring structure
+ * \param len Number of bytes written
+ */
+void slipc_io_ring_write_commit(slipc_io_ring_t *self, size_t len);
+
+/**
+ * \brief Get the contiguous readable data of the ring.
+ *
+ * Consumer only. The data stays valid until it is released with
+ * slipc_io_ring_read_commit().
+ *
+ * \param self Pointer to the ring structure
+ * \param len Pointer to the length of the readable data
+ *
+ * \return Pointer to the readable data
+ */
+uint8_t const *slipc_io_ring_read_peek(slipc_io_ring_t *self, size_t *len);
+
+/**
+ * \brief Release len bytes of the data from slipc_io_ring_read_peek().
+ *
+ * \param self Pointer to the ring structure
+ * \param len Number of bytes consumed
+ */
+void slipc_io_ring_read_commit(slipc_io_ring_t *self, size_t len);
+
+/**
+ * \brief Create a writer for writing to a ring, producer only.
+ *
+ * The writer returns SLIPC_WRITER_EOF if the data does not fit.
+ *
+ * \param self Pointer to the initialized ring structure
+ *
+ * \return Initialized writer structure
+ */
+slipc_io_writer_t slipc_io_writer_from_ring(slipc_io_ring_t *self);
+
+/**
+ * \brief Create a reader for reading from a ring, consumer only.
+ *
+ * The reader never ends the stream. It returns SLIPC_IO_READER_AGAIN while
+ * the ring is empty, so a transfer keeps its place in a frame until the
+ * producer writes the rest.
+ *
+ * \param self Pointer to the initialized ring structure
+ *
+ * \return Initialized reader structure
+ */
+slipc_io_reader_t slipc_io_reader_from_ring(slipc_io_ring_t *self);
+
+/**
+ * \brief Callback function type for starting a DMA transfer.
+ *
+ * Called from the writer, or from slipc_io_dma_writer_complete() in the DMA
+ * interrupt. The data stays untouched until the transfer completes.
+ *
+ * \param user_ctx User context
+ * \param data Pointer to the data to be transmitted
+ * \param len Length of the data, never 0
+ */
+typedef void (*slipc_io_dma_start_cb)(slipc_io_user_ctx_t user_ctx,
+                                      const uint8_t *data, size_t len);
+
+/**
+ * \brief Double buffered writer for DMA transmission.
+ *
+ * One buffer is filled while the other one is transmitted. Frames span
+ * buffer boundaries freely, the writer copies whole runs at a time.
+ */
+typedef struct slipc_io_dma_writer {
+  uint8_t *buf[2];                   /**< Transfer buffers */
+  size_t size;                       /**< Size of each buffer */
+  size_t fill;                       /**< Index of the buffer being filled */
+  size_t len;                        /**< Bytes in the buffer being filled */
+  bool open;                         /**< Frame data written since END */
+  slipc_io_atomic_size_t state;      /**< Transfer running and lock flags */
+  struct slipc_io_user_ctx user_ctx; /**< User context of start */
+  slipc_io_dma_start_cb start;       /**< Starts a transfer */
+} slipc_io_dma_writer_t;
+
+/**
+ * \brief Create a writer for transmitting through DMA.
+ *
+ * A transfer is started once a buffer is full, or when a write ends a frame
+ * with its END byte and no transfer is running. A lone END, the start byte of
+ * the next frame, stays buffered. Data written while a transfer runs goes out
+ * as soon as it completes.
+ *
+ * If both buffers are in use, the writer takes what fits and returns
+ * SLIPC_IO_WRITER_AGAIN, slipc_encoder_transfer() continues the frame on the
+ * next call.
+ *
+ * \param self Pointer to the DMA writer structure
+ * \param buf_a First buffer, aligned as the DMA engine needs it
+ * \param buf_b Second buffer of the same size
+ * \param size Size of each buffer, must not be 0
+ * \param start Callback starting a transfer
+ * \param user_ctx User context passed to start
+ *
+ * \return Initialized writer structure
+ */
+slipc_io_writer_t slipc_io_writer_from_dma(slipc_io_dma_writer_t *self,
+                                            uint8_t *buf_a, uint8_t *buf_b,
+                                            size_t size,
+                                            slipc_io_dma_start_cb start,
+                                            slipc_io_user_ctx_t user_ctx);
+
+/**
+ * \brief Start a transfer of the buffered bytes, if none is running.
+ *
+ * \param self Pointer to the DMA writer structure
+ *
+ * \retval SLIPC_IO_WRITER_OK Nothing left buffered
+ * \retval SLIPC_IO_WRITER_AGAIN The bytes go out after the running transfer
+ */
+slipc_io_writer_result_t
+slipc_io_dma_writer_flush(slipc_io_dma_writer_t *self);
+
+/**
+ * \brief Report a completed transfer, the completion hook.
+ *
+ * Call this from the DMA transfer complete interrupt. Starts the next
+ * transfer right away if data was written meanwhile.
+ *
+ * \param self Pointer to the DMA writer structure
+ */
+void slipc_io_dma_writer_complete(slipc_io_dma_writer_t *self);
+
 #ifdef __cplusplus
 }
 #endif
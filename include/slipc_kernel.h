@@ -0,0 +1,75 @@
+/**
+ * \file slipc_kernel.h
+ * \brief SLIPC kernel selection at run time.
+ *
+ * The buffer paths of the encoder and decoder skip over ordinary bytes with a
+ * scan kernel. All kernels the compiler can build are part of the library,
+ * the best one the CPU supports is picked on first use through cpuid on x86
+ * and getauxval() on Linux ARM64. One binary runs everywhere without giving
+ * up the wide kernels on newer CPUs.
+ *
+ * LICENSE: This library is released under the MIT License.
+ */
+#ifndef _SLIPC_KERNEL_H_
+#define _SLIPC_KERNEL_H_
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Scan kernels.
+ */
+typedef enum slipc_kernel {
+  SLIPC_KERNEL_AUTO,   /**< Best kernel the CPU supports */
+  SLIPC_KERNEL_SCALAR, /**< Portable 64-bit SWAR, table decoder */
+  SLIPC_KERNEL_SSE2,   /**< 16 bytes per step on x86 */
+  SLIPC_KERNEL_AVX2,   /**< 32 bytes per step on x86 */
+  SLIPC_KERNEL_AVX512, /**< 64 bytes per step on x86 with AVX-512BW */
+  SLIPC_KERNEL_NEON,   /**< 16 bytes per step on ARM */
+  SLIPC_KERNEL_COUNT,  /**< Number of kernels */
+} slipc_kernel_t;
+
+/**
+ * \brief Get the kernel in use, detecting the CPU on the first call.
+ *
+ * \return Kernel in use, never SLIPC_KERNEL_AUTO
+ */
+slipc_kernel_t slipc_kernel_get(void);
+
+/**
+ * \brief Check if a kernel is built in and supported by the CPU.
+ *
+ * \param kernel Kernel
+ *
+ * \return true if slipc_kernel_set() accepts the kernel
+ */
+bool slipc_kernel_supported(slipc_kernel_t kernel);
+
+/**
+ * \brief Override the kernel, e.g. to test or compare all of them.
+ *
+ * Applies to all encoders and decoders of the process. All kernels give the
+ * same results, calls running in other threads may finish with the old one.
+ *
+ * \param kernel Kernel, SLIPC_KERNEL_AUTO for the best supported one
+ *
+ * \return false if the kernel is not supported, the kernel in use stays
+ */
+bool slipc_kernel_set(slipc_kernel_t kernel);
+
+/**
+ * \brief Get the name of a kernel.
+ *
+ * \param kernel Kernel
+ *
+ * \return Name of the kernel, e.g. "avx2"
+ */
+const char *slipc_kernel_name(slipc_kernel_t kernel);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* _SLIPC_KERNEL_H_ */
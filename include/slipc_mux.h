@@ -0,0 +1,160 @@
+/**
+ * \file slipc_mux.h
+ * \brief SLIPC channel manager, decodes many serial channels at once.
+ *
+ * Every channel has its own decoder state and frame buffer, completed frames
+ * go to the frame callback of their channel like with the framer.
+ *
+ * The state a channel needs between chunks is kept in arrays indexed by
+ * channel, a few bytes each, instead of a full slipc_decoder_t per channel.
+ * Round robin over many channels then touches a few cache lines of state.
+ * The state of a channel is loaded into a single decoder for its chunk and
+ * stored back after it, so all channels decode like slipc_decoder_feed().
+ *
+ * All memory comes from a caller provided arena, see slipc_mux_arena_size().
+ * A channel manager is not thread safe.
+ *
+ * LICENSE: This library is released under the MIT License.
+ */
+#ifndef _SLIPC_MUX_H_
+#define _SLIPC_MUX_H_
+
+#include "slipc.h"
+#include "slipc_framer.h"
+#include "slipc_io.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Frame callback of a channel.
+ */
+typedef struct slipc_mux_handler {
+  slipc_framer_frame_cb on_frame;    /**< Frame callback, NULL to discard */
+  struct slipc_io_user_ctx user_ctx; /**< User context */
+} slipc_mux_handler_t;
+
+/**
+ * \brief Chunk of input for one channel.
+ */
+typedef struct slipc_mux_input {
+  size_t channel;     /**< Channel the data was received on */
+  const uint8_t *buf; /**< Pointer to the data buffer */
+  size_t len;         /**< Length of the data buffer */
+} slipc_mux_input_t;
+
+/**
+ * \brief Channel manager structure.
+ *
+ * The arrays point into the arena and hold one entry per channel. The
+ * statistics of the decoder count all channels together.
+ */
+typedef struct slipc_mux {
+  slipc_decoder_t decoder;       /**< Decoder the channels run on */
+  size_t channels;               /**< Number of channels */
+  size_t frame_size;             /**< Size of each frame buffer */
+  uint8_t *prev;                 /**< Previous byte processed */
+  uint8_t *flags;                /**< Malformed, in frame and oversize bits */
+  uint32_t *frame_len;           /**< Bytes decoded from the current frame */
+  uint32_t *crc;                 /**< Checksum register of the current frame */
+  size_t *frames;                /**< Frames delivered */
+  size_t *dropped;               /**< Frames dropped, oversize or checksum */
+  slipc_mux_handler_t *handlers; /**< Frame callbacks */
+  uint8_t *bufs;                 /**< Frame buffers, frame_size apart */
+} slipc_mux_t;
+
+/**
+ * \brief Get the arena size needed by a channel manager.
+ *
+ * \param channels Number of channels
+ * \param frame_size Size of the frame buffer of each channel
+ *
+ * \return Number of bytes slipc_mux_init() needs
+ */
+size_t slipc_mux_arena_size(size_t channels, size_t frame_size);
+
+/**
+ * \brief Initialize a channel manager.
+ *
+ * All channels start without a frame callback, their frames are discarded.
+ *
+ * \param self Pointer to the channel manager structure
+ * \param startbyte Indicates if we should expect a start byte
+ * \param channels Number of channels
+ * \param frame_size Size of each frame buffer, frames that are longer are
+ *                   dropped, at most UINT32_MAX
+ * \param arena Arena, pointer aligned, needs to be alive as long as the
+ *              channel manager
+ * \param arena_len Length of the arena, at least slipc_mux_arena_size()
+ */
+void slipc_mux_init(slipc_mux_t *self, bool startbyte, size_t channels,
+                    size_t frame_size, void *arena, size_t arena_len);
+
+/**
+ * \brief Set the checksum expected at the end of frames on all channels.
+ *
+ * Frames that fail it are dropped and delivered frames come without it.
+ *
+ * \param self Pointer to the channel manager structure
+ * \param kind Checksum
+ */
+void slipc_mux_set_crc(slipc_mux_t *self, slipc_crc_kind_t kind);
+
+/**
+ * \brief Set the frame callback of a channel.
+ *
+ * \param self Pointer to the channel manager structure
+ * \param channel Channel
+ * \param on_frame Frame callback function, NULL to discard frames
+ * \param user_ctx User context passed to the callback
+ */
+void slipc_mux_set_handler(slipc_mux_t *self, size_t channel,
+                           slipc_framer_frame_cb on_frame,
+                           slipc_io_user_ctx_t user_ctx);
+
+/**
+ * \brief Drop the incomplete frame of a channel, e.g. after reopening it.
+ *
+ * \param self Pointer to the channel manager structure
+ * \param channel Channel
+ */
+void slipc_mux_reset(slipc_mux_t *self, size_t channel);
+
+/**
+ * \brief Decode a chunk of one channel and deliver all frames completed by it.
+ *
+ * The chunk is always consumed completely, an incomplete frame at its end is
+ * continued by the next chunk of the same channel. Frame callbacks must not
+ * feed the channel manager, all channels share its decoder.
+ *
+ * \param self Pointer to the channel manager structure
+ * \param channel Channel the data was received on
+ * \param buf Pointer to the data buffer
+ * \param len Length of the data buffer
+ *
+ * \return Number of frames delivered
+ */
+size_t slipc_mux_feed(slipc_mux_t *self, size_t channel, const uint8_t *buf,
+                      size_t len);
+
+/**
+ * \brief Decode chunks of any channels in order.
+ *
+ * \param self Pointer to the channel manager structure
+ * \param inputs Array of chunks
+ * \param count Number of chunks
+ *
+ * \return Number of frames delivered
+ */
+size_t slipc_mux_feed_batch(slipc_mux_t *self, const slipc_mux_input_t *inputs,
+                            size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* _SLIPC_MUX_H_ */
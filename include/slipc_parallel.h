@@ -0,0 +1,64 @@
+/**
+ * \file slipc_parallel.h
+ * \brief SLIPC parallel decoder for recorded captures.
+ *
+ * Decodes a buffer of back-to-back frames on several threads. The buffer is
+ * split right after END bytes, where the decoder state is known, so every
+ * part decodes independently and no split can land after an ESC.
+ *
+ * Every END ends a frame and empty frames are skipped, so captures written
+ * with and without start bytes decode alike. Noise between frames is decoded
+ * as frames as well.
+ *
+ * Needs POSIX threads, built as the separate slipc_parallel library.
+ *
+ * LICENSE: This library is released under the MIT License.
+ */
+#ifndef _SLIPC_PARALLEL_H_
+#define _SLIPC_PARALLEL_H_
+
+#include "slipc.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Maximum number of threads used by slipc_decode_parallel().
+ */
+#ifndef SLIPC_PARALLEL_MAX_THREADS
+#define SLIPC_PARALLEL_MAX_THREADS 64
+#endif
+
+/**
+ * \brief Decode all frames of a capture on several threads.
+ *
+ * Frames are described in capture order. Decoded frames are not contiguous,
+ * each is written to out at the offset of its encoded form in buf.
+ *
+ * \param buf Pointer to the capture
+ * \param len Length of the capture, set to the number of bytes consumed
+ * \param out Output buffer, at least as long as the capture
+ * \param frames Array of frame descriptors, offsets point into out
+ * \param frame_count Capacity of the frames array, set to the number of
+ *                    frames found
+ * \param threads Number of threads including the calling one, at most
+ *                SLIPC_PARALLEL_MAX_THREADS
+ *
+ * \retval SLIPC_DECODER_EOF Frames array full, call again with the rest
+ * \retval SLIPC_DECODER_MORE No complete frame left, the rest is an
+ *                           incomplete frame
+ */
+slipc_decoder_result_t slipc_decode_parallel(const uint8_t *buf, size_t *len,
+                                             uint8_t *out,
+                                             slipc_frame_desc_t *frames,
+                                             size_t *frame_count,
+                                             unsigned threads);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* _SLIPC_PARALLEL_H_ */
@@ -0,0 +1,74 @@
+/**
+ * \file slipc_pool.h
+ * \brief SLIPC frame pool.
+ *
+ * Fixed size frame buffers carved out of a caller provided arena. Free frames
+ * are kept in an intrusive free list, so acquire and release are O(1) and no
+ * heap is involved.
+ *
+ * A pool is not thread safe, acquire and release need to happen on the same
+ * thread or be serialized by the caller.
+ *
+ * LICENSE: This library is released under the MIT License.
+ */
+#ifndef _SLIPC_POOL_H_
+#define _SLIPC_POOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Free frame, overlays the first bytes of the frame buffer.
+ */
+typedef struct slipc_pool_node {
+  struct slipc_pool_node *next; /**< Next free frame */
+} slipc_pool_node_t;
+
+/**
+ * \brief Frame pool structure.
+ */
+typedef struct slipc_pool {
+  slipc_pool_node_t *free; /**< First free frame */
+  size_t frame_size;       /**< Usable size of each frame */
+  size_t available;        /**< Number of free frames */
+} slipc_pool_t;
+
+/**
+ * \brief Initialize a frame pool.
+ *
+ * The arena is split into as many frames as fit. The stride of the frames is
+ * frame_size rounded up to pointer alignment.
+ *
+ * \param self Pointer to the pool structure
+ * \param arena Arena, pointer aligned, needs to be alive as long as the pool
+ * \param arena_len Length of the arena
+ * \param frame_size Size of each frame
+ */
+void slipc_pool_init(slipc_pool_t *self, void *arena, size_t arena_len,
+                     size_t frame_size);
+
+/**
+ * \brief Take a frame out of the pool.
+ *
+ * \param self Pointer to the pool structure
+ *
+ * \return Pointer to a frame of frame_size bytes, NULL if none is available
+ */
+uint8_t *slipc_pool_acquire(slipc_pool_t *self);
+
+/**
+ * \brief Give a frame back to the pool.
+ *
+ * \param self Pointer to the pool structure
+ * \param frame Pointer to a frame acquired from this pool
+ */
+void slipc_pool_release(slipc_pool_t *self, uint8_t *frame);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* _SLIPC_POOL_H_ */
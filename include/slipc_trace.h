@@ -0,0 +1,127 @@
+/**
+ * \file slipc_trace.h
+ * \brief SLIPC tracing of frame latency and reader/writer calls.
+ *
+ * With SLIPC_ENABLE_TRACE set, the encoder and decoder statistics carry a
+ * slipc_trace_t. slipc_encoder_transfer() and slipc_decoder_transfer() then
+ * time every frame and every reader and writer call they make, which tells
+ * time spent in SLIPC from time spent in the callbacks. Without it, the
+ * statistics and transfer loops are exactly as before.
+ *
+ * The trace lives in the encoder or decoder, so it is per thread like them
+ * and needs no locking. Hand a copy to another thread as a snapshot and
+ * combine traces of several threads with slipc_trace_merge().
+ *
+ * LICENSE: This library is released under the MIT License.
+ */
+#ifndef _SLIPC_TRACE_H_
+#define _SLIPC_TRACE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Trace encoder and decoder transfers.
+ *
+ * Changes the layout of the statistics, so the library and its users need
+ * the same value. The SLIPC_TRACE CMake option sets it for both.
+ */
+#ifndef SLIPC_ENABLE_TRACE
+#define SLIPC_ENABLE_TRACE 0
+#endif
+
+/**
+ * \brief Number of histogram buckets.
+ */
+#define SLIPC_TRACE_BUCKETS 32
+
+/**
+ * \brief Histogram with power of two buckets.
+ *
+ * Bucket 0 counts zeros, bucket i counts values from 2^(i-1) up to 2^i, the
+ * last bucket counts everything above.
+ */
+typedef struct slipc_trace_histogram {
+  size_t count[SLIPC_TRACE_BUCKETS]; /**< Values per bucket */
+  uint64_t sum;                      /**< Sum of all values */
+  uint64_t max;                      /**< Largest value */
+} slipc_trace_histogram_t;
+
+/**
+ * \brief Trace of a transfer, part of the encoder and decoder statistics.
+ */
+typedef struct slipc_trace {
+  slipc_trace_histogram_t frame_ns;    /**< Nanoseconds per frame */
+  slipc_trace_histogram_t frame_bytes; /**< Bytes consumed per frame */
+  slipc_trace_histogram_t io_ns;       /**< Nanoseconds per callback */
+  size_t reader_calls;                 /**< Reader callbacks */
+  size_t writer_calls;                 /**< Writer callbacks */
+  uint64_t pending_ns;                 /**< Time on the current frame */
+  size_t pending_bytes;                /**< Bytes of the current frame */
+} slipc_trace_t;
+
+/**
+ * \brief Clock used by the trace, in nanoseconds.
+ *
+ * Defaults to slipc_trace_now(). Define it when building the library to use
+ * a cycle counter or another clock instead.
+ */
+#ifndef SLIPC_TRACE_NOW
+#define SLIPC_TRACE_NOW() slipc_trace_now()
+#endif
+
+/**
+ * \brief Current time of a monotonic clock.
+ *
+ * Uses clock_gettime(CLOCK_MONOTONIC) on POSIX and the C23 TIME_MONOTONIC
+ * base of timespec_get() elsewhere. Only without either it falls back to
+ * TIME_UTC, which jumps when the wall clock is set.
+ *
+ * \return Time in nanoseconds, 0 if the clock fails
+ */
+uint64_t slipc_trace_now(void);
+
+/**
+ * \brief Add a value to a histogram.
+ *
+ * \param self Pointer to the histogram structure
+ * \param value Value to add
+ */
+void slipc_trace_record(slipc_trace_histogram_t *self, uint64_t value);
+
+/**
+ * \brief Get the number of values in a histogram.
+ *
+ * \param self Pointer to the histogram structure
+ *
+ * \return Number of values added
+ */
+size_t slipc_trace_count(const slipc_trace_histogram_t *self);
+
+/**
+ * \brief Estimate a percentile of a histogram.
+ *
+ * \param self Pointer to the histogram structure
+ * \param permille Percentile in thousandths, 500 for the median
+ *
+ * \return Upper bound of the bucket holding the percentile, 0 if empty
+ */
+uint64_t slipc_trace_percentile(const slipc_trace_histogram_t *self,
+                                unsigned permille);
+
+/**
+ * \brief Add a trace to another one, e.g. to combine threads.
+ *
+ * \param dst Pointer to the combined trace
+ * \param src Pointer to the trace to add
+ */
+void slipc_trace_merge(slipc_trace_t *dst, const slipc_trace_t *src);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* _SLIPC_TRACE_H_ */
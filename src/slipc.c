@@ -10,10 +10,40 @@
  */
 #include "slipc.h"
 #include "slipc_io.h"
+#include "slipc_scan.h"
+#include "slipc_table.h"
 #include <assert.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
+
+/**
+ * \brief Use the table driven kernel to decode into memory.
+ *
+ * Defaults to the choice of the scan kernel in use, see
+ * slipc_scan_decode_table().
+ */
+#ifndef SLIPC_DECODE_TABLE
+#define SLIPC_DECODE_TABLE slipc_scan_decode_table()
+#endif
+
+/**
+ * \brief Count encoder and decoder statistics.
+ */
+#ifndef SLIPC_ENABLE_STATS
+#define SLIPC_ENABLE_STATS 1
+#endif
+
+#if SLIPC_ENABLE_STATS
+#define SLIPC_STAT_ADD(stats, field, n) ((stats).field += (n))
+#else
+#define SLIPC_STAT_ADD(stats, field, n) ((void)(stats), (void)(n))
+#endif
+
+#if SLIPC_ENABLE_TRACE && !SLIPC_ENABLE_STATS
+#error "SLIPC_ENABLE_TRACE needs SLIPC_ENABLE_STATS"
+#endif
 
 /**
  * \brief Write the END byte to the writer.
@@ -26,48 +56,351 @@
  */
 static slipc_io_writer_result_t slipc_write_end_byte(slipc_io_writer_t *writer);
 
+/**
+ * \brief Make sure the lookahead of the decoder holds data.
+ *
+ * Reads a new chunk from the reader if the lookahead is empty.
+ *
+ * \param self Decoder structure
+ * \param reader Reader structure
+ *
+ * \retval SLIPC_DECODER_MORE Lookahead holds data
+ * \retval SLIPC_DECODER_NOT_FOUND No more data available
+ * \retval SLIPC_DECODER_IO_ERROR I/O error occurred
+ * \retval SLIPC_DECODER_AGAIN Reader would block
+ */
+static slipc_decoder_result_t slipc_fill_lookahead(slipc_decoder_t *self,
+                                                   slipc_io_reader_t *reader);
+
 /**
  * \brief Skip to the start byte in the reader.
  *
+ * \param self Decoder structure
  * \param reader Reader structure
  *
  * \retval SLIPC_DECODER_MORE Start byte found
  * \retval SLIPC_DECODER_NOT_FOUND Start byte not found
  * \retval SLIPC_DECODER_IO_ERROR I/O error occurred
+ * \retval SLIPC_DECODER_AGAIN Reader would block
+ */
+static slipc_decoder_result_t slipc_skip_to_start(slipc_decoder_t *self,
+                                                  slipc_io_reader_t *reader);
+
+/**
+ * \brief Write exactly len bytes to the writer.
+ *
+ * \param writer Writer structure
+ * \param data Pointer to the data to be written
+ * \param len Length of the data
+ *
+ * \return true if all bytes were written
+ */
+static bool slipc_write_exact(slipc_io_writer_t *writer, uint8_t const *data,
+                              size_t len);
+
+/**
+ * \brief Write exactly count segments to the vectored writer.
+ *
+ * \param writer Vectored writer structure
+ * \param vecs Pointer to the segments
+ * \param count Number of segments
+ *
+ * \return true if all segments were written
+ */
+static bool slipc_write_vec_exact(slipc_io_vec_writer_t *writer,
+                                  slipc_io_vec_t const *vecs, size_t count);
+
+/**
+ * \brief Encode a buffer into a writer.
+ *
+ * Runs without special bytes are written with a single call, escape sequences
+ * are written as one two byte call each.
+ *
+ * \param writer Writer structure
+ * \param buf Pointer to the data buffer
+ * \param len Length of the data buffer
+ * \param escapes Incremented by the number of escape sequences written
+ * \param kind Checksum, ignored without crc
+ * \param crc Checksum register the buffer is run through, or NULL
+ *
+ * \retval SLIPC_ENCODER_OK Operation successful
+ * \retval SLIPC_ENCODER_IO_ERROR I/O error occurred
+ */
+static slipc_encoder_result_t
+slipc_encode_span(slipc_io_writer_t *writer, uint8_t const *buf, size_t len,
+                  size_t *escapes, slipc_crc_kind_t kind, uint32_t *crc);
+
+/**
+ * \brief Escape a buffer into memory.
+ *
+ * \param out Output buffer, needs room for the escaped data
+ * \param buf Pointer to the data buffer
+ * \param len Length of the data buffer
+ *
+ * \return Number of bytes written
+ */
+static size_t slipc_escape_into(uint8_t *out, uint8_t const *buf, size_t len);
+
+/**
+ * \brief Write to the writer, telling a short write from an error.
+ *
+ * \param writer Writer structure
+ * \param data Pointer to the data to be written
+ * \param len Length of the data, set to the number of bytes written
+ *
+ * \retval SLIPC_ENCODER_OK All bytes written
+ * \retval SLIPC_ENCODER_AGAIN Writer took less or would block
+ * \retval SLIPC_ENCODER_IO_ERROR I/O error occurred
+ */
+static slipc_encoder_result_t slipc_encoder_put(slipc_io_writer_t *writer,
+                                                uint8_t const *data,
+                                                size_t *len);
+
+/**
+ * \brief Encode a buffer into a writer, continuing where the encoder left.
+ *
+ * Like slipc_encode_span(), but a short write leaves pos and the pending
+ * escape byte of the encoder where the next call picks up.
+ *
+ * \param self Encoder structure
+ * \param writer Writer structure
+ * \param buf Pointer to the data buffer
+ * \param len Length of the data buffer
+ * \param pos Bytes of the buffer already encoded, advanced
+ * \param crc Checksum register the encoded bytes are run through, or NULL
+ *
+ * \retval SLIPC_ENCODER_OK Buffer encoded completely
+ * \retval SLIPC_ENCODER_AGAIN Writer took less or would block
+ * \retval SLIPC_ENCODER_IO_ERROR I/O error occurred
+ */
+static slipc_encoder_result_t
+slipc_encode_resume(slipc_encoder_t *self, slipc_io_writer_t *writer,
+                    uint8_t const *buf, size_t len, size_t *pos,
+                    uint32_t *crc);
+
+/**
+ * \brief Write the start byte of a frame unless already done.
+ *
+ * \param self Encoder structure
+ * \param writer Writer structure
+ * \param startbyte Indicates if the start byte should be used
+ *
+ * \retval SLIPC_ENCODER_OK Frame started
+ * \retval SLIPC_ENCODER_AGAIN Writer would block
+ * \retval SLIPC_ENCODER_IO_ERROR I/O error occurred
+ */
+static slipc_encoder_result_t slipc_encoder_begin(slipc_encoder_t *self,
+                                                  slipc_io_writer_t *writer,
+                                                  bool startbyte);
+
+/**
+ * \brief Write the checksum, if any, and the END byte and finish the frame.
+ *
+ * \param self Encoder structure
+ * \param writer Writer structure
+ *
+ * \retval SLIPC_ENCODER_OK Frame finished
+ * \retval SLIPC_ENCODER_AGAIN Writer would block
+ * \retval SLIPC_ENCODER_IO_ERROR I/O error occurred
+ */
+static slipc_encoder_result_t slipc_encoder_finish(slipc_encoder_t *self,
+                                                   slipc_io_writer_t *writer);
+
+/**
+ * \brief Encode from a reader into a writer, slipc_encoder_transfer()
+ * without the trace.
+ */
+static slipc_encoder_result_t
+slipc_encoder_transfer_run(slipc_encoder_t *self, slipc_io_reader_t *reader,
+                           slipc_io_writer_t *writer);
+
+#if SLIPC_ENABLE_TRACE
+/**
+ * \brief Reader and writer of a traced transfer.
+ *
+ * Stands in for the reader and writer of the transfer, so every callback is
+ * timed without touching the helpers that make the calls.
+ */
+typedef struct slipc_trace_io {
+  slipc_trace_t *trace;            /**< Trace to record into */
+  slipc_io_reader_t *reader;       /**< Reader of the transfer */
+  slipc_io_writer_t *writer;       /**< Writer of the transfer */
+  slipc_io_reader_t traced_reader; /**< Reader timing the calls */
+  slipc_io_writer_t traced_writer; /**< Writer timing the calls */
+  uint64_t start;                  /**< Start of the transfer call */
+  size_t bytes_in;                 /**< Bytes consumed before the call */
+} slipc_trace_io_t;
+
+/**
+ * \brief Start tracing a transfer call.
+ *
+ * \param io Trace I/O structure
+ * \param trace Trace to record into
+ * \param reader Reader of the transfer, replaced by the timing one
+ * \param writer Writer of the transfer, replaced by the timing one
+ * \param bytes_in Bytes consumed so far
+ */
+static void slipc_trace_begin(slipc_trace_io_t *io, slipc_trace_t *trace,
+                              slipc_io_reader_t **reader,
+                              slipc_io_writer_t **writer, size_t bytes_in);
+
+/**
+ * \brief Finish tracing a transfer call.
+ *
+ * Time and bytes of calls that return AGAIN add up to the frame they resume.
+ *
+ * \param io Trace I/O structure
+ * \param bytes_in Bytes consumed so far
+ * \param frame_end Indicates if the call completed a frame
+ * \param again Indicates if the frame resumes with the next call
+ */
+static void slipc_trace_end(slipc_trace_io_t *io, size_t bytes_in,
+                            bool frame_end, bool again);
+#endif
+
+/**
+ * \brief Destination of the buffer decoder.
+ *
+ * Either a writer or, if writer is NULL, a memory buffer. The memory buffer
+ * may overlap the input as long as it does not run ahead of it.
+ */
+typedef struct slipc_sink {
+  slipc_io_writer_t *writer; /**< Writer, NULL for memory output */
+  uint8_t *buf;              /**< Next free byte of the memory output */
+  size_t len;                /**< Remaining space, SIZE_MAX for a writer */
+  slipc_crc_kind_t crc_kind; /**< Checksum of data put into a writer */
+  uint32_t *crc;             /**< Checksum register, for a writer */
+} slipc_sink_t;
+
+/**
+ * \brief Put data into a sink.
+ *
+ * A sink takes as much as its remaining space allows and sets len to that
+ * amount, a writer sink fails if the writer does not take all of it. Data put
+ * into a writer runs through its checksum.
+ *
+ * \param sink Sink structure
+ * \param data Pointer to the data
+ * \param len Length of the data, set to the number of bytes taken
+ *
+ * \return false if the writer failed
+ */
+static bool slipc_sink_put(slipc_sink_t *sink, uint8_t const *data,
+                           size_t *len);
+
+/**
+ * \brief Decode a buffer into a sink.
+ *
+ * Behaves exactly like calling slipc_decode_byte() for every byte, but runs
+ * without special bytes are put into the sink at once. Enforces the maximum
+ * frame length of the decoder and skips the rest of oversize frames. Checks
+ * the checksum of complete frames.
+ *
+ * \param self Decoder structure
+ * \param sink Sink structure
+ * \param buf Pointer to the data buffer
+ * \param len Length of the data buffer, set to the number of bytes consumed
+ *
+ * \retval SLIPC_DECODER_EOF SLIP_END byte found
+ * \retval SLIPC_DECODER_CRC_ERROR SLIP_END byte found, checksum is wrong
+ * \retval SLIPC_DECODER_MORE Buffer consumed or memory sink full
+ * \retval SLIPC_DECODER_IO_ERROR I/O error occurred
+ */
+static slipc_decoder_result_t slipc_decode_span(slipc_decoder_t *self,
+                                                slipc_sink_t *sink,
+                                                uint8_t const *buf,
+                                                size_t *len);
+
+/**
+ * \brief Decode a buffer into a sink, without a frame length limit.
+ *
+ * Same contract as slipc_decode_span().
+ *
+ * \param self Decoder structure
+ * \param sink Sink structure
+ * \param buf Pointer to the data buffer
+ * \param len Length of the data buffer, set to the number of bytes consumed
+ *
+ * \retval SLIPC_DECODER_EOF End of packet reached
+ * \retval SLIPC_DECODER_MORE Buffer consumed or sink full
+ * \retval SLIPC_DECODER_IO_ERROR I/O error occurred
+ */
+static slipc_decoder_result_t slipc_decode_run(slipc_decoder_t *self,
+                                               slipc_sink_t *sink,
+                                               uint8_t const *buf,
+                                               size_t *len);
+
+/**
+ * \brief Skip the rest of an oversize frame.
+ *
+ * \param self Decoder structure
+ * \param buf Pointer to the data buffer
+ * \param len Length of the data buffer, set to the number of bytes consumed
+ *
+ * \retval SLIPC_DECODER_EOF End of packet reached
+ * \retval SLIPC_DECODER_MORE Buffer consumed
+ */
+static slipc_decoder_result_t slipc_skip_oversize(slipc_decoder_t *self,
+                                                  uint8_t const *buf,
+                                                  size_t *len);
+
+/**
+ * \brief Reset the per frame state of the decoder at the start of a frame.
+ *
+ * \param self Decoder structure
+ */
+static void slipc_frame_begin(slipc_decoder_t *self);
+
+/**
+ * \brief Count bytes consumed while looking for a start byte.
+ *
+ * \param self Decoder structure
+ * \param skipped Number of bytes before the start byte
+ * \param found Indicates if the start byte was consumed as well
+ */
+static void slipc_stat_hunt(slipc_decoder_t *self, size_t skipped, bool found);
+
+/**
+ * \brief Decode a buffer into a memory sink using slipc_decode_table.
+ *
+ * Same contract as slipc_decode_span(), every byte costs a table lookup and
+ * a store but no data dependent branch.
+ *
+ * \param self Decoder structure
+ * \param sink Memory sink structure
+ * \param buf Pointer to the data buffer
+ * \param len Length of the data buffer, set to the number of bytes consumed
+ *
+ * \retval SLIPC_DECODER_EOF SLIP_END byte found
+ * \retval SLIPC_DECODER_MORE Buffer consumed or memory sink full
  */
-static slipc_decoder_result_t slipc_skip_to_start(slipc_io_reader_t *reader);
+static slipc_decoder_result_t slipc_decode_span_table(slipc_decoder_t *self,
+                                                      slipc_sink_t *sink,
+                                                      uint8_t const *buf,
+                                                      size_t *len);
 
 slipc_encoder_result_t slipc_encode_byte(slipc_io_writer_t *writer,
                                          uint8_t byte) {
   assert(writer);
 
-  uint8_t stuffbyte = 0;
+  uint8_t out[2] = {byte, 0};
+  size_t len = 1;
   switch (byte) {
   case SLIPC_END:
-    byte = SLIPC_ESC;
-    stuffbyte = SLIPC_ESC_END;
+    out[0] = SLIPC_ESC;
+    out[1] = SLIPC_ESC_END;
+    len = 2;
     break;
   case SLIPC_ESC:
-    byte = SLIPC_ESC;
-    stuffbyte = SLIPC_ESC_ESC;
+    out[0] = SLIPC_ESC;
+    out[1] = SLIPC_ESC_ESC;
+    len = 2;
     break;
   }
 
-  if (stuffbyte != 0) {
-    size_t len = 1;
-    if (slipc_io_writer_write(writer, &byte, &len) != SLIPC_IO_WRITER_OK ||
-        len != 1) {
-      return SLIPC_ENCODER_IO_ERROR;
-    }
-    byte = stuffbyte;
-  }
-
-  size_t len = 1;
-  if (slipc_io_writer_write(writer, &byte, &len) != SLIPC_IO_WRITER_OK ||
-      len != 1) {
+  if (!slipc_write_exact(writer, out, len)) {
     return SLIPC_ENCODER_IO_ERROR;
   }
-
   return SLIPC_ENCODER_OK;
 }
 
@@ -79,10 +412,27 @@ void slipc_encoder_init(slipc_encoder_t *self, bool startbyte) {
 slipc_encoder_t slipc_encoder_new(bool startbyte) {
   slipc_encoder_t self = {
       .startbyte = startbyte,
+      .stats = {0},
   };
   return self;
 }
 
+void slipc_encoder_set_chunk(slipc_encoder_t *self, uint8_t *buf,
+                             size_t size) {
+  assert(self);
+  assert(!self->in_frame);
+  assert(!buf || size > 0);
+
+  self->chunk = buf;
+  self->chunk_size = buf ? size : 0;
+}
+
+void slipc_encoder_set_crc(slipc_encoder_t *self, slipc_crc_kind_t kind) {
+  assert(self);
+  assert(!self->in_frame);
+  self->crc_kind = kind;
+}
+
 slipc_encoder_result_t slipc_encoder_transfer(slipc_encoder_t *self,
                                               slipc_io_reader_t *reader,
                                               slipc_io_writer_t *writer) {
@@ -90,46 +440,265 @@ slipc_encoder_result_t slipc_encoder_transfer(slipc_encoder_t *self,
   assert(writer);
   assert(reader);
 
-  uint8_t byte;
+#if SLIPC_ENABLE_TRACE
+  slipc_trace_io_t io;
+  slipc_trace_begin(&io, &self->stats.trace, &reader, &writer,
+                    self->stats.bytes_in);
+  slipc_encoder_result_t res = slipc_encoder_transfer_run(self, reader, writer);
+  slipc_trace_end(&io, self->stats.bytes_in, res == SLIPC_ENCODER_OK,
+                  res == SLIPC_ENCODER_AGAIN);
+  return res;
+#else
+  return slipc_encoder_transfer_run(self, reader, writer);
+#endif
+}
 
-  if (self->startbyte) {
-    if (slipc_write_end_byte(writer) != SLIPC_IO_WRITER_OK) {
-      return SLIPC_ENCODER_IO_ERROR;
-    }
+static slipc_encoder_result_t
+slipc_encoder_transfer_run(slipc_encoder_t *self, slipc_io_reader_t *reader,
+                           slipc_io_writer_t *writer) {
+  slipc_encoder_result_t enc_res =
+      slipc_encoder_begin(self, writer, self->startbyte);
+  if (enc_res != SLIPC_ENCODER_OK) {
+    return enc_res;
   }
 
+  uint8_t *const chunk = self->chunk ? self->chunk : &self->byte;
+  size_t const size = self->chunk ? self->chunk_size : 1;
+  uint32_t *const crc = self->crc_kind != SLIPC_CRC_NONE ? &self->crc : NULL;
+
   while (1) {
-    size_t len = 1;
-    slipc_io_reader_result_t res = slipc_io_reader_read(reader, &byte, &len);
+    if (self->pos == self->chunk_len && !self->reader_eof) {
+      size_t len = size;
+      slipc_io_reader_result_t res = slipc_io_reader_read(reader, chunk, &len);
 
-    if (len != 1 || res == SLIPC_IO_READER_ERROR) {
-      return SLIPC_ENCODER_IO_ERROR;
+      if (len == 0 && res == SLIPC_IO_READER_AGAIN) {
+        return SLIPC_ENCODER_AGAIN;
+      }
+      if (res == SLIPC_IO_READER_ERROR || len > size ||
+          (len == 0 && res == SLIPC_IO_READER_MORE)) {
+        return SLIPC_ENCODER_IO_ERROR;
+      }
+
+      self->pos = 0;
+      self->chunk_len = len;
+      self->reader_eof = res == SLIPC_IO_READER_EOF;
+      SLIPC_STAT_ADD(self->stats, bytes_in, len);
     }
 
-    if (slipc_encode_byte(writer, byte) != SLIPC_ENCODER_OK) {
-      return SLIPC_ENCODER_IO_ERROR;
+    enc_res = slipc_encode_resume(self, writer, chunk, self->chunk_len,
+                                  &self->pos, crc);
+    if (enc_res != SLIPC_ENCODER_OK) {
+      return enc_res;
     }
 
-    if (res == SLIPC_IO_READER_EOF) {
-      if (slipc_write_end_byte(writer) != SLIPC_IO_WRITER_OK) {
-        return SLIPC_ENCODER_IO_ERROR;
-      }
-      return SLIPC_ENCODER_OK;
+    if (self->reader_eof) {
+      return slipc_encoder_finish(self, writer);
+    }
+  }
+}
+
+slipc_encoder_result_t slipc_encoder_write(slipc_encoder_t *self,
+                                           slipc_io_writer_t *writer,
+                                           uint8_t const *buf, size_t len) {
+  assert(self);
+  assert(writer);
+  assert(buf || len == 0);
+
+  bool const fresh = !self->in_frame;
+  slipc_encoder_result_t res =
+      slipc_encoder_begin(self, writer, self->startbyte);
+  if (res != SLIPC_ENCODER_OK) {
+    return res;
+  }
+  if (fresh) {
+    SLIPC_STAT_ADD(self->stats, bytes_in, len);
+  }
+
+  uint32_t *const crc = self->crc_kind != SLIPC_CRC_NONE ? &self->crc : NULL;
+  res = slipc_encode_resume(self, writer, buf, len, &self->pos, crc);
+  if (res != SLIPC_ENCODER_OK) {
+    return res;
+  }
+
+  return slipc_encoder_finish(self, writer);
+}
+
+/**
+ * \brief Shared body of slipc_encode_packet() and its _sb/_nosb variants.
+ *
+ * Inlined into each of them, so a constant startbyte folds away.
+ */
+static inline slipc_encoder_result_t
+slipc_encode_packet_impl(slipc_io_writer_t *writer, uint8_t const *buf,
+                         size_t len, bool const startbyte) {
+  assert(writer);
+  assert(buf);
+
+  if (startbyte) {
+    if (slipc_write_end_byte(writer) != SLIPC_IO_WRITER_OK) {
+      return SLIPC_ENCODER_IO_ERROR;
     }
   }
+
+  size_t escapes = 0;
+  if (slipc_encode_span(writer, buf, len, &escapes, SLIPC_CRC_NONE, NULL) !=
+      SLIPC_ENCODER_OK) {
+    return SLIPC_ENCODER_IO_ERROR;
+  }
+
+  if (slipc_write_end_byte(writer) != SLIPC_IO_WRITER_OK) {
+    return SLIPC_ENCODER_IO_ERROR;
+  }
+  return SLIPC_ENCODER_OK;
 }
 
 slipc_encoder_result_t slipc_encode_packet(slipc_io_writer_t *writer,
                                            uint8_t const *buf, size_t len,
                                            bool startbyte) {
+  return slipc_encode_packet_impl(writer, buf, len, startbyte);
+}
+
+slipc_encoder_result_t slipc_encode_packet_sb(slipc_io_writer_t *writer,
+                                              uint8_t const *buf, size_t len) {
+  return slipc_encode_packet_impl(writer, buf, len, true);
+}
+
+slipc_encoder_result_t slipc_encode_packet_nosb(slipc_io_writer_t *writer,
+                                                uint8_t const *buf,
+                                                size_t len) {
+  return slipc_encode_packet_impl(writer, buf, len, false);
+}
+
+slipc_encoder_result_t slipc_encode_packet_crc(slipc_io_writer_t *writer,
+                                               uint8_t const *buf, size_t len,
+                                               bool startbyte,
+                                               slipc_crc_kind_t kind) {
+  assert(writer);
+  assert(buf);
+
+  if (startbyte) {
+    if (slipc_write_end_byte(writer) != SLIPC_IO_WRITER_OK) {
+      return SLIPC_ENCODER_IO_ERROR;
+    }
+  }
+
+  uint32_t crc = slipc_crc_init(kind);
+  size_t escapes = 0;
+  if (slipc_encode_span(writer, buf, len, &escapes, kind, &crc) !=
+      SLIPC_ENCODER_OK) {
+    return SLIPC_ENCODER_IO_ERROR;
+  }
+
+  // Every trailer byte may need an escape, plus the END byte.
+  uint8_t trailer[SLIPC_CRC_SIZE_MAX];
+  uint8_t out[2 * SLIPC_CRC_SIZE_MAX + 1];
+  size_t n = slipc_crc_trailer(kind, crc, trailer);
+  n = slipc_escape_into(out, trailer, n);
+  out[n++] = SLIPC_END;
+
+  if (!slipc_write_exact(writer, out, n)) {
+    return SLIPC_ENCODER_IO_ERROR;
+  }
+  return SLIPC_ENCODER_OK;
+}
+
+slipc_encoder_result_t slipc_encode_packet_vec(slipc_io_vec_writer_t *writer,
+                                               uint8_t const *buf, size_t len,
+                                               bool startbyte) {
   assert(writer);
   assert(buf);
 
-  slipc_io_buffer_reader_t reader_ctx;
-  slipc_io_reader_t reader = slipc_io_reader_from_buffer(&reader_ctx, buf, len);
+  static uint8_t const end = SLIPC_END;
+  static uint8_t const esc_end[2] = {SLIPC_ESC, SLIPC_ESC_END};
+  static uint8_t const esc_esc[2] = {SLIPC_ESC, SLIPC_ESC_ESC};
+
+  slipc_io_vec_t vecs[SLIPC_ENCODER_VEC_COUNT];
+  size_t count = 0;
+
+  if (startbyte) {
+    vecs[count++] = (slipc_io_vec_t){&end, 1};
+  }
+
+  while (1) {
+    // Leave room for a run, its escape sequence and the END byte.
+    if (count + 3 > SLIPC_ENCODER_VEC_COUNT) {
+      if (!slipc_write_vec_exact(writer, vecs, count)) {
+        return SLIPC_ENCODER_IO_ERROR;
+      }
+      count = 0;
+    }
+
+    if (len == 0) {
+      break;
+    }
+
+    size_t run = slipc_scan_special(buf, len);
+    if (run > 0) {
+      vecs[count++] = (slipc_io_vec_t){buf, run};
+      buf += run;
+      len -= run;
+    }
+
+    if (len > 0) {
+      uint8_t const *escaped = *buf == SLIPC_END ? esc_end : esc_esc;
+      vecs[count++] = (slipc_io_vec_t){escaped, 2};
+      buf++;
+      len--;
+    }
+  }
+
+  vecs[count++] = (slipc_io_vec_t){&end, 1};
+  if (!slipc_write_vec_exact(writer, vecs, count)) {
+    return SLIPC_ENCODER_IO_ERROR;
+  }
+  return SLIPC_ENCODER_OK;
+}
+
+size_t slipc_encoded_size(uint8_t const *buf, size_t len, bool startbyte) {
+  assert(buf);
+  return len + slipc_count_special(buf, len) + 1 + (startbyte ? 1 : 0);
+}
+
+slipc_encoder_result_t slipc_encode_frames(uint8_t *out, size_t *len,
+                                           slipc_io_vec_t const *frames,
+                                           size_t *count, size_t *offsets,
+                                           bool startbyte) {
+  assert(out);
+  assert(len);
+  assert(count);
+  assert(frames || *count == 0);
+
+  size_t const size = *len;
+  size_t pos = 0;
+  size_t i = 0;
+  slipc_encoder_result_t res = SLIPC_ENCODER_OK;
+
+  for (; i < *count; i++) {
+    uint8_t const *buf = frames[i].data;
+    size_t const n = frames[i].len;
+    assert(buf || n == 0);
+
+    // Only count the escapes if the worst case does not fit.
+    if (size - pos < SLIPC_ENCODED_SIZE_MAX(n, startbyte) &&
+        size - pos < n + slipc_count_special(buf, n) + 1 + startbyte) {
+      res = SLIPC_ENCODER_AGAIN;
+      break;
+    }
+
+    if (startbyte) {
+      out[pos++] = SLIPC_END;
+    }
+    pos += slipc_escape_into(out + pos, buf, n);
+    out[pos++] = SLIPC_END;
+
+    if (offsets) {
+      offsets[i] = pos;
+    }
+  }
 
-  slipc_encoder_t encoder = slipc_encoder_new(startbyte);
-  return slipc_encoder_transfer(&encoder, &reader, writer);
+  *len = pos;
+  *count = i;
+  return res;
 }
 
 void slipc_decoder_init(slipc_decoder_t *self, bool startbyte) {
@@ -142,6 +711,16 @@ slipc_decoder_t slipc_decoder_new(bool startbyte) {
       .startbyte = startbyte,
       .prev = SLIPC_END,
       .malformed = false,
+      .in_frame = false,
+      .oversize = false,
+      .max_len = 0,
+      .frame_len = 0,
+      .crc_kind = SLIPC_CRC_NONE,
+      .crc = 0,
+      .stats = {0},
+      .lookahead_pos = 0,
+      .lookahead_len = 0,
+      .reader_eof = false,
   };
   return self;
 }
@@ -151,6 +730,22 @@ bool slipc_decoder_is_malformed(slipc_decoder_t *self) {
   return self->malformed;
 }
 
+void slipc_decoder_set_max_len(slipc_decoder_t *self, size_t max_len) {
+  assert(self);
+  self->max_len = max_len;
+}
+
+bool slipc_decoder_is_oversize(slipc_decoder_t *self) {
+  assert(self);
+  return self->oversize;
+}
+
+void slipc_decoder_set_crc(slipc_decoder_t *self, slipc_crc_kind_t kind) {
+  assert(self);
+  self->crc_kind = kind;
+  self->crc = slipc_crc_init(kind);
+}
+
 static slipc_io_writer_result_t slipc_write_byte(slipc_io_writer_t *writer,
                                                  uint8_t byte) {
   size_t len = 1;
@@ -200,46 +795,131 @@ slipc_decoder_result_t slipc_decode_byte(slipc_decoder_t *self,
   return SLIPC_DECODER_MORE;
 }
 
-// TODO: implement results
-slipc_decoder_result_t slipc_decoder_transfer(slipc_decoder_t *self,
-                                              slipc_io_reader_t *reader,
-                                              slipc_io_writer_t *writer) {
-  assert(self);
-  assert(reader);
-  assert(writer);
-
-  uint8_t byte;
+/**
+ * \brief Decode from a reader into a writer, slipc_decoder_transfer_impl()
+ * without the trace.
+ */
+static inline slipc_decoder_result_t
+slipc_decoder_transfer_run(slipc_decoder_t *self, slipc_io_reader_t *reader,
+                           slipc_io_writer_t *writer, bool const startbyte) {
+  slipc_decoder_result_t res;
 
-  if (self->startbyte) {
-    if (slipc_skip_to_start(reader) != SLIPC_DECODER_MORE) {
+  if (startbyte && !self->in_frame) {
+    res = slipc_skip_to_start(self, reader);
+    if (res == SLIPC_DECODER_AGAIN) {
+      return res;
+    }
+    if (res != SLIPC_DECODER_MORE) {
       return SLIPC_DECODER_NOT_FOUND;
     }
+    slipc_frame_begin(self);
   }
 
+  slipc_sink_t sink = {.writer = writer, .len = SIZE_MAX};
+
   while (1) {
-    size_t len = 1;
+    res = slipc_fill_lookahead(self, reader);
+    if (res != SLIPC_DECODER_MORE) {
+      break;
+    }
 
-    slipc_io_reader_result_t read_res =
-        slipc_io_reader_read(reader, &byte, &len);
+    size_t len = self->lookahead_len;
+    res = slipc_decode_span(self, &sink, self->lookahead + self->lookahead_pos,
+                            &len);
+    self->lookahead_pos += len;
+    self->lookahead_len -= len;
 
-    if (len == 0 && read_res == SLIPC_IO_READER_EOF) {
-      return SLIPC_DECODER_NOT_FOUND;
+    if (res != SLIPC_DECODER_MORE) {
+      break;
     }
 
-    if (len != 1 || read_res == SLIPC_IO_READER_ERROR) {
-      return SLIPC_DECODER_IO_ERROR;
+    if (self->reader_eof) {
+      self->reader_eof = false;
+      break;
     }
+  }
 
-    slipc_decoder_result_t decode_res = slipc_decode_byte(self, writer, byte);
-    if (decode_res == SLIPC_DECODER_EOF) {
-      return SLIPC_DECODER_EOF;
-    }
+  // The start byte is already consumed if the packet is resumed.
+  self->in_frame = res == SLIPC_DECODER_AGAIN;
+  return res;
+}
 
-    if (!(decode_res == SLIPC_DECODER_MORE &&
-          read_res == SLIPC_IO_READER_MORE)) {
-      return SLIPC_DECODER_MORE;
+/**
+ * \brief Shared body of slipc_decoder_transfer() and its _sb/_nosb variants.
+ *
+ * Inlined into each of them, so a constant startbyte folds away.
+ */
+static inline slipc_decoder_result_t
+slipc_decoder_transfer_impl(slipc_decoder_t *self, slipc_io_reader_t *reader,
+                            slipc_io_writer_t *writer, bool const startbyte) {
+  assert(self);
+  assert(reader);
+  assert(writer);
+
+#if SLIPC_ENABLE_TRACE
+  slipc_trace_io_t io;
+  slipc_trace_begin(&io, &self->stats.trace, &reader, &writer,
+                    self->stats.bytes_in);
+  slipc_decoder_result_t res =
+      slipc_decoder_transfer_run(self, reader, writer, startbyte);
+  slipc_trace_end(&io, self->stats.bytes_in,
+                  res == SLIPC_DECODER_EOF || res == SLIPC_DECODER_CRC_ERROR,
+                  res == SLIPC_DECODER_AGAIN);
+  return res;
+#else
+  return slipc_decoder_transfer_run(self, reader, writer, startbyte);
+#endif
+}
+
+slipc_decoder_result_t slipc_decoder_transfer(slipc_decoder_t *self,
+                                              slipc_io_reader_t *reader,
+                                              slipc_io_writer_t *writer) {
+  assert(self);
+  return slipc_decoder_transfer_impl(self, reader, writer, self->startbyte);
+}
+
+slipc_decoder_result_t slipc_decoder_transfer_sb(slipc_decoder_t *self,
+                                                 slipc_io_reader_t *reader,
+                                                 slipc_io_writer_t *writer) {
+  return slipc_decoder_transfer_impl(self, reader, writer, true);
+}
+
+slipc_decoder_result_t slipc_decoder_transfer_nosb(slipc_decoder_t *self,
+                                                   slipc_io_reader_t *reader,
+                                                   slipc_io_writer_t *writer) {
+  return slipc_decoder_transfer_impl(self, reader, writer, false);
+}
+
+/**
+ * \brief Shared body of slipc_decoder_decode_packet() and its variants.
+ *
+ * Inlined into each of them, so a constant startbyte folds away.
+ */
+static inline slipc_decoder_result_t
+slipc_decoder_decode_packet_impl(slipc_decoder_t *self,
+                                 slipc_io_writer_t *writer, uint8_t const *buf,
+                                 size_t len, bool const startbyte) {
+  assert(self);
+  assert(writer);
+  assert(buf);
+
+  if (startbyte) {
+    size_t start = slipc_scan_end(buf, len);
+    slipc_stat_hunt(self, start, start < len);
+    if (start == len) {
+      return SLIPC_DECODER_NOT_FOUND;
     }
+    buf += start + 1;
+    len -= start + 1;
+    slipc_frame_begin(self);
+  }
+
+  if (len == 0) {
+    return SLIPC_DECODER_NOT_FOUND;
   }
+
+  slipc_sink_t sink = {.writer = writer, .len = SIZE_MAX};
+  return slipc_decode_span(self, &sink, buf, &len);
 }
 
 slipc_decoder_result_t slipc_decoder_decode_packet(slipc_decoder_t *self,
@@ -247,12 +927,192 @@ slipc_decoder_result_t slipc_decoder_decode_packet(slipc_decoder_t *self,
                                                    uint8_t const *buf,
                                                    size_t len) {
   assert(self);
-  assert(writer);
+  return slipc_decoder_decode_packet_impl(self, writer, buf, len,
+                                          self->startbyte);
+}
+
+slipc_decoder_result_t slipc_decoder_decode_packet_sb(slipc_decoder_t *self,
+                                                      slipc_io_writer_t *writer,
+                                                      uint8_t const *buf,
+                                                      size_t len) {
+  return slipc_decoder_decode_packet_impl(self, writer, buf, len, true);
+}
+
+slipc_decoder_result_t
+slipc_decoder_decode_packet_nosb(slipc_decoder_t *self,
+                                 slipc_io_writer_t *writer, uint8_t const *buf,
+                                 size_t len) {
+  return slipc_decoder_decode_packet_impl(self, writer, buf, len, false);
+}
+
+slipc_decoder_result_t slipc_decoder_decode_packet_in_place(
+    slipc_decoder_t *self, uint8_t *buf, size_t *len, size_t *out_len) {
+  assert(self);
+  assert(buf);
+  assert(len);
+  assert(out_len);
+
+  size_t start = 0;
+  *out_len = 0;
+
+  if (self->startbyte) {
+    start = slipc_scan_end(buf, *len);
+    slipc_stat_hunt(self, start, start < *len);
+    if (start == *len) {
+      return SLIPC_DECODER_NOT_FOUND;
+    }
+    start++;
+    slipc_frame_begin(self);
+  }
+
+  if (start == *len) {
+    return SLIPC_DECODER_NOT_FOUND;
+  }
+
+  slipc_sink_t sink = {.buf = buf, .len = *len};
+  size_t consumed = *len - start;
+  slipc_decoder_result_t res =
+      slipc_decode_span(self, &sink, buf + start, &consumed);
+
+  *out_len = *len - sink.len;
+  *len = start + consumed;
+  return res;
+}
+
+/**
+ * \brief Shared body of slipc_decoder_feed() and its _sb/_nosb variants.
+ *
+ * Inlined into each of them, so a constant startbyte folds away.
+ */
+static inline slipc_decoder_result_t
+slipc_decoder_feed_impl(slipc_decoder_t *self, uint8_t const *in,
+                        size_t *in_len, uint8_t *out, size_t *out_len,
+                        bool const startbyte) {
+  assert(self);
+  assert(in);
+  assert(in_len);
+  assert(out);
+  assert(out_len);
+
+  size_t consumed = 0;
+
+  if (!self->in_frame) {
+    if (startbyte) {
+      size_t start = slipc_scan_end(in, *in_len);
+      slipc_stat_hunt(self, start, start < *in_len);
+      if (start == *in_len) {
+        *out_len = 0;
+        return SLIPC_DECODER_NOT_FOUND;
+      }
+      consumed = start + 1;
+    }
+    self->in_frame = true;
+    self->malformed = false;
+    slipc_frame_begin(self);
+  }
+
+  slipc_sink_t sink = {.buf = out, .len = *out_len};
+  size_t len = *in_len - consumed;
+  slipc_decoder_result_t res =
+      slipc_decode_span(self, &sink, in + consumed, &len);
+
+  if (res == SLIPC_DECODER_EOF || res == SLIPC_DECODER_CRC_ERROR) {
+    self->in_frame = false;
+  }
+
+  *in_len = consumed + len;
+  *out_len -= sink.len;
+  return res;
+}
+
+slipc_decoder_result_t slipc_decoder_feed(slipc_decoder_t *self,
+                                          uint8_t const *in, size_t *in_len,
+                                          uint8_t *out, size_t *out_len) {
+  assert(self);
+  return slipc_decoder_feed_impl(self, in, in_len, out, out_len,
+                                 self->startbyte);
+}
+
+slipc_decoder_result_t slipc_decoder_feed_sb(slipc_decoder_t *self,
+                                             uint8_t const *in, size_t *in_len,
+                                             uint8_t *out, size_t *out_len) {
+  return slipc_decoder_feed_impl(self, in, in_len, out, out_len, true);
+}
+
+slipc_decoder_result_t slipc_decoder_feed_nosb(slipc_decoder_t *self,
+                                               uint8_t const *in,
+                                               size_t *in_len, uint8_t *out,
+                                               size_t *out_len) {
+  return slipc_decoder_feed_impl(self, in, in_len, out, out_len, false);
+}
+
+slipc_decoder_result_t
+slipc_decoder_decode_frames(slipc_decoder_t *self, uint8_t const *buf,
+                            size_t *len, uint8_t *out, size_t out_len,
+                            slipc_frame_desc_t *frames, size_t *frame_count) {
+  assert(self);
   assert(buf);
+  assert(len);
+  assert(out);
+  assert(frame_count);
+  assert(frames || *frame_count == 0);
+
+  size_t consumed = 0;
+  size_t produced = 0;
+  size_t count = 0;
+  slipc_decoder_result_t res = SLIPC_DECODER_MORE;
+
+  while (consumed < *len) {
+    if (count == *frame_count) {
+      res = SLIPC_DECODER_EOF;
+      break;
+    }
+
+    slipc_decoder_t const saved = *self;
+    size_t in_len = *len - consumed;
+    size_t frame_len = out_len - produced;
+    slipc_decoder_result_t feed_res = slipc_decoder_feed(
+        self, buf + consumed, &in_len, out + produced, &frame_len);
+
+    if (feed_res == SLIPC_DECODER_MORE && consumed + in_len < *len &&
+        produced == 0) {
+      // The frame does not fit even the whole output, truncate it.
+      self->oversize = true;
+      SLIPC_STAT_ADD(self->stats, oversize, 1);
+      size_t rest = *len - consumed - in_len;
+      size_t none = 0;
+      feed_res = slipc_decoder_feed(self, buf + consumed + in_len, &rest,
+                                    out + frame_len, &none);
+      in_len += rest;
+    }
+
+    if (feed_res != SLIPC_DECODER_EOF &&
+        feed_res != SLIPC_DECODER_CRC_ERROR) {
+      // Leave the incomplete frame for the next call.
+      *self = saved;
+      if (feed_res == SLIPC_DECODER_NOT_FOUND) {
+        consumed = *len;
+      } else if (consumed + in_len < *len) {
+        res = SLIPC_DECODER_EOF;
+      }
+      break;
+    }
+
+    frames[count] = (slipc_frame_desc_t){
+        .offset = produced,
+        .len = frame_len,
+        .malformed = self->malformed,
+        .crc_error = feed_res == SLIPC_DECODER_CRC_ERROR,
+        .oversize = self->oversize,
+    };
+    count++;
+    consumed += in_len;
+    produced += frame_len;
+  }
 
-  slipc_io_buffer_reader_t reader_ctx;
-  slipc_io_reader_t reader = slipc_io_reader_from_buffer(&reader_ctx, buf, len);
-  return slipc_decoder_transfer(self, &reader, writer);
+  *len = consumed;
+  *frame_count = count;
+  return res;
 }
 
 static slipc_io_writer_result_t
@@ -262,23 +1122,569 @@ slipc_write_end_byte(slipc_io_writer_t *writer) {
   return slipc_io_writer_write(writer, &start, &len);
 }
 
-static slipc_decoder_result_t slipc_skip_to_start(slipc_io_reader_t *reader) {
-  uint8_t byte;
+static slipc_decoder_result_t slipc_fill_lookahead(slipc_decoder_t *self,
+                                                   slipc_io_reader_t *reader) {
+  if (self->lookahead_len > 0) {
+    return SLIPC_DECODER_MORE;
+  }
+
+  size_t len = sizeof(self->lookahead);
+  slipc_io_reader_result_t res =
+      slipc_io_reader_read(reader, self->lookahead, &len);
+
+  if (res == SLIPC_IO_READER_ERROR || len > sizeof(self->lookahead)) {
+    return SLIPC_DECODER_IO_ERROR;
+  }
+
+  if (len == 0) {
+    if (res == SLIPC_IO_READER_AGAIN) {
+      return SLIPC_DECODER_AGAIN;
+    }
+    return res == SLIPC_IO_READER_EOF ? SLIPC_DECODER_NOT_FOUND
+                                      : SLIPC_DECODER_IO_ERROR;
+  }
+
+  self->lookahead_pos = 0;
+  self->lookahead_len = len;
+  self->reader_eof = res == SLIPC_IO_READER_EOF;
+  return SLIPC_DECODER_MORE;
+}
+
+static slipc_decoder_result_t slipc_skip_to_start(slipc_decoder_t *self,
+                                                  slipc_io_reader_t *reader) {
   while (1) {
-    size_t len = 1;
+    slipc_decoder_result_t res = slipc_fill_lookahead(self, reader);
+    if (res != SLIPC_DECODER_MORE) {
+      return res;
+    }
+
+    uint8_t const *chunk = self->lookahead + self->lookahead_pos;
+    size_t start = slipc_scan_end(chunk, self->lookahead_len);
 
-    slipc_io_reader_result_t res = slipc_io_reader_read(reader, &byte, &len);
+    slipc_stat_hunt(self, start, start < self->lookahead_len);
 
-    if (len > 1 || res == SLIPC_IO_READER_ERROR) {
-      return SLIPC_DECODER_IO_ERROR;
+    if (start < self->lookahead_len) {
+      self->lookahead_pos += start + 1;
+      self->lookahead_len -= start + 1;
+      return SLIPC_DECODER_MORE;
+    }
+
+    self->lookahead_len = 0;
+  }
+}
+
+static bool slipc_write_exact(slipc_io_writer_t *writer, uint8_t const *data,
+                              size_t len) {
+  size_t written = len;
+  return slipc_io_writer_write(writer, data, &written) == SLIPC_IO_WRITER_OK &&
+         written == len;
+}
+
+static bool slipc_write_vec_exact(slipc_io_vec_writer_t *writer,
+                                  slipc_io_vec_t const *vecs, size_t count) {
+  size_t written = count;
+  return slipc_io_vec_writer_write(writer, vecs, &written) ==
+             SLIPC_IO_WRITER_OK &&
+         written == count;
+}
+
+static slipc_encoder_result_t
+slipc_encode_span(slipc_io_writer_t *writer, uint8_t const *buf, size_t len,
+                  size_t *escapes, slipc_crc_kind_t kind, uint32_t *crc) {
+  static uint8_t const esc_end[2] = {SLIPC_ESC, SLIPC_ESC_END};
+  static uint8_t const esc_esc[2] = {SLIPC_ESC, SLIPC_ESC_ESC};
+
+  while (len > 0) {
+    size_t run = slipc_scan_special(buf, len);
+    if (run > 0) {
+      // Checksum the run while it is hot in the cache from the scan.
+      if (crc) {
+        *crc = slipc_crc_update(kind, *crc, buf, run);
+      }
+      if (!slipc_write_exact(writer, buf, run)) {
+        return SLIPC_ENCODER_IO_ERROR;
+      }
+      buf += run;
+      len -= run;
     }
 
     if (len == 0) {
-      return SLIPC_DECODER_NOT_FOUND;
+      break;
     }
 
-    if (byte == SLIPC_END) {
-      return SLIPC_DECODER_MORE;
+    if (crc) {
+      *crc = slipc_crc_update(kind, *crc, buf, 1);
+    }
+    uint8_t const *escaped = *buf == SLIPC_END ? esc_end : esc_esc;
+    if (!slipc_write_exact(writer, escaped, 2)) {
+      return SLIPC_ENCODER_IO_ERROR;
     }
+    (*escapes)++;
+    buf++;
+    len--;
+  }
+
+  return SLIPC_ENCODER_OK;
+}
+
+static size_t slipc_escape_into(uint8_t *out, uint8_t const *buf,
+                                size_t len) {
+  uint8_t *const begin = out;
+
+  while (len > 0) {
+    size_t run = slipc_scan_special(buf, len);
+    memcpy(out, buf, run);
+    out += run;
+    buf += run;
+    len -= run;
+
+    if (len == 0) {
+      break;
+    }
+
+    *out++ = SLIPC_ESC;
+    *out++ = *buf == SLIPC_END ? SLIPC_ESC_END : SLIPC_ESC_ESC;
+    buf++;
+    len--;
+  }
+
+  return (size_t)(out - begin);
+}
+
+static slipc_encoder_result_t slipc_encoder_put(slipc_io_writer_t *writer,
+                                                uint8_t const *data,
+                                                size_t *len) {
+  size_t const n = *len;
+  slipc_io_writer_result_t res = slipc_io_writer_write(writer, data, len);
+  if (res == SLIPC_IO_WRITER_OK && *len == n) {
+    return SLIPC_ENCODER_OK;
+  }
+  return res == SLIPC_IO_WRITER_OK || res == SLIPC_IO_WRITER_AGAIN
+             ? SLIPC_ENCODER_AGAIN
+             : SLIPC_ENCODER_IO_ERROR;
+}
+
+static slipc_encoder_result_t
+slipc_encode_resume(slipc_encoder_t *self, slipc_io_writer_t *writer,
+                    uint8_t const *buf, size_t len, size_t *pos,
+                    uint32_t *crc) {
+  static uint8_t const esc_end[2] = {SLIPC_ESC, SLIPC_ESC_END};
+  static uint8_t const esc_esc[2] = {SLIPC_ESC, SLIPC_ESC_ESC};
+  slipc_encoder_result_t res;
+
+  if (self->pending) {
+    size_t n = 1;
+    res = slipc_encoder_put(writer, &self->pending, &n);
+    if (res != SLIPC_ENCODER_OK) {
+      return res;
+    }
+    self->pending = 0;
+  }
+
+  while (*pos < len) {
+    size_t run = slipc_scan_special(buf + *pos, len - *pos);
+    if (run > 0) {
+      res = slipc_encoder_put(writer, buf + *pos, &run);
+      if (crc) {
+        *crc = slipc_crc_update(self->crc_kind, *crc, buf + *pos, run);
+      }
+      *pos += run;
+      if (res != SLIPC_ENCODER_OK) {
+        return res;
+      }
+      continue;
+    }
+
+    uint8_t const *escaped = buf[*pos] == SLIPC_END ? esc_end : esc_esc;
+    size_t n = 2;
+    res = slipc_encoder_put(writer, escaped, &n);
+    if (n > 0) {
+      // The escape counts as done, a missing second byte is kept pending.
+      if (crc) {
+        *crc = slipc_crc_update(self->crc_kind, *crc, buf + *pos, 1);
+      }
+      (*pos)++;
+      self->pending = n == 1 ? escaped[1] : 0;
+      SLIPC_STAT_ADD(self->stats, escapes, 1);
+    }
+    if (res != SLIPC_ENCODER_OK) {
+      return res;
+    }
+  }
+
+  return SLIPC_ENCODER_OK;
+}
+
+static slipc_encoder_result_t slipc_encoder_begin(slipc_encoder_t *self,
+                                                  slipc_io_writer_t *writer,
+                                                  bool startbyte) {
+  if (self->in_frame) {
+    return SLIPC_ENCODER_OK;
+  }
+
+  if (startbyte) {
+    uint8_t const start = SLIPC_END;
+    size_t n = 1;
+    slipc_encoder_result_t res = slipc_encoder_put(writer, &start, &n);
+    if (res != SLIPC_ENCODER_OK) {
+      return res;
+    }
+  }
+
+  self->in_frame = true;
+  self->pending = 0;
+  self->pos = 0;
+  self->chunk_len = 0;
+  self->reader_eof = false;
+  self->crc = slipc_crc_init(self->crc_kind);
+  self->trailer_len = 0;
+  self->trailer_pos = 0;
+  return SLIPC_ENCODER_OK;
+}
+
+static slipc_encoder_result_t slipc_encoder_finish(slipc_encoder_t *self,
+                                                   slipc_io_writer_t *writer) {
+  slipc_encoder_result_t res;
+
+  if (self->crc_kind != SLIPC_CRC_NONE) {
+    // The register is final once the payload is encoded, fix the trailer.
+    if (self->trailer_len == 0) {
+      self->trailer_len =
+          (uint8_t)slipc_crc_trailer(self->crc_kind, self->crc, self->trailer);
+    }
+    size_t pos = self->trailer_pos;
+    res = slipc_encode_resume(self, writer, self->trailer, self->trailer_len,
+                              &pos, NULL);
+    self->trailer_pos = (uint8_t)pos;
+    if (res != SLIPC_ENCODER_OK) {
+      return res;
+    }
+  }
+
+  uint8_t const end = SLIPC_END;
+  size_t n = 1;
+  res = slipc_encoder_put(writer, &end, &n);
+  if (res != SLIPC_ENCODER_OK) {
+    return res;
+  }
+
+  self->in_frame = false;
+  SLIPC_STAT_ADD(self->stats, frames, 1);
+  return SLIPC_ENCODER_OK;
+}
+
+static bool slipc_sink_put(slipc_sink_t *sink, uint8_t const *data,
+                           size_t *len) {
+  *len = sink->len < *len ? sink->len : *len;
+
+  if (sink->writer) {
+    sink->len -= *len;
+    if (sink->crc_kind != SLIPC_CRC_NONE) {
+      *sink->crc = slipc_crc_update(sink->crc_kind, *sink->crc, data, *len);
+    }
+    return *len == 0 || slipc_write_exact(sink->writer, data, *len);
+  }
+
+  if (*len > 0) {
+    // Output may trail the input when decoding in place.
+    memmove(sink->buf, data, *len);
+  }
+  sink->buf += *len;
+  sink->len -= *len;
+  return true;
+}
+
+static slipc_decoder_result_t slipc_decode_span(slipc_decoder_t *self,
+                                                slipc_sink_t *sink,
+                                                uint8_t const *buf,
+                                                size_t *len) {
+  if (self->prev == SLIPC_END) {
+    slipc_frame_begin(self);
+  }
+
+  slipc_decoder_result_t res;
+
+  if (self->oversize) {
+    res = slipc_skip_oversize(self, buf, len);
+  } else {
+    // Let the sink run full at the maximum frame length.
+    size_t const room =
+        self->max_len ? self->max_len - self->frame_len : SIZE_MAX;
+    size_t const space = sink->len;
+    size_t const limit = space < room ? space : room;
+    sink->len = limit;
+
+    size_t const n = *len;
+    if (sink->writer) {
+      sink->crc_kind = self->crc_kind;
+      sink->crc = &self->crc;
+    }
+    res = slipc_decode_run(self, sink, buf, len);
+
+    size_t const emitted = limit - sink->len;
+    sink->len = space - emitted;
+    if (!sink->writer && self->crc_kind != SLIPC_CRC_NONE) {
+      // Memory output is contiguous, run it through the checksum at once.
+      self->crc = slipc_crc_update(self->crc_kind, self->crc,
+                                   sink->buf - emitted, emitted);
+    }
+    self->frame_len += emitted;
+    SLIPC_STAT_ADD(self->stats, bytes_out, emitted);
+
+    if (res == SLIPC_DECODER_MORE && *len < n && emitted == room) {
+      // The next byte would exceed the maximum frame length.
+      self->oversize = true;
+      SLIPC_STAT_ADD(self->stats, oversize, 1);
+      size_t rest = n - *len;
+      res = slipc_skip_oversize(self, buf + *len, &rest);
+      *len += rest;
+    }
+  }
+
+  SLIPC_STAT_ADD(self->stats, bytes_in, *len);
+  if (res == SLIPC_DECODER_EOF) {
+    SLIPC_STAT_ADD(self->stats, frames, 1);
+    SLIPC_STAT_ADD(self->stats, empty, !self->oversize && !self->frame_len);
+
+    if (self->crc_kind != SLIPC_CRC_NONE && !self->oversize &&
+        self->frame_len > 0 && !slipc_crc_check(self->crc_kind, self->crc)) {
+      SLIPC_STAT_ADD(self->stats, crc_errors, 1);
+      res = SLIPC_DECODER_CRC_ERROR;
+    }
+  }
+
+  return res;
+}
+
+static slipc_decoder_result_t slipc_skip_oversize(slipc_decoder_t *self,
+                                                  uint8_t const *buf,
+                                                  size_t *len) {
+  // END always terminates a frame, no need to decode the rest.
+  size_t end = slipc_scan_end(buf, *len);
+  if (end == *len) {
+    if (*len > 0) {
+      self->prev = buf[*len - 1];
+    }
+    return SLIPC_DECODER_MORE;
+  }
+
+  self->prev = SLIPC_END;
+  *len = end + 1;
+  return SLIPC_DECODER_EOF;
+}
+
+static void slipc_frame_begin(slipc_decoder_t *self) {
+  self->oversize = false;
+  self->frame_len = 0;
+  self->crc = slipc_crc_init(self->crc_kind);
+}
+
+static void slipc_stat_hunt(slipc_decoder_t *self, size_t skipped, bool found) {
+  SLIPC_STAT_ADD(self->stats, skipped, skipped);
+  SLIPC_STAT_ADD(self->stats, bytes_in, skipped + (found ? 1 : 0));
+}
+
+static slipc_decoder_result_t slipc_decode_run(slipc_decoder_t *self,
+                                               slipc_sink_t *sink,
+                                               uint8_t const *buf,
+                                               size_t *len) {
+  if (!sink->writer && SLIPC_DECODE_TABLE) {
+    return slipc_decode_span_table(self, sink, buf, len);
+  }
+
+  size_t const n = *len;
+  size_t i = 0;
+
+  while (i < n) {
+    if (self->prev == SLIPC_ESC) {
+      uint8_t byte = buf[i];
+
+      switch (byte) {
+      case SLIPC_END:
+        self->prev = byte;
+        *len = i + 1;
+        return SLIPC_DECODER_EOF;
+      case SLIPC_ESC_END:
+        byte = SLIPC_END;
+        break;
+      case SLIPC_ESC_ESC:
+        byte = SLIPC_ESC;
+        break;
+      default:
+        break;
+      }
+
+      size_t put = 1;
+      if (!slipc_sink_put(sink, &byte, &put)) {
+        *len = i;
+        return SLIPC_DECODER_IO_ERROR;
+      }
+      if (put == 0) {
+        break;
+      }
+
+      if (buf[i] != SLIPC_ESC_END && buf[i] != SLIPC_ESC_ESC) {
+        // Malformed packet, but let's just keep those bytes in the output.
+        self->malformed = true;
+        SLIPC_STAT_ADD(self->stats, invalid_escapes, 1);
+      }
+      self->prev = buf[i++];
+      continue;
+    }
+
+    size_t run = slipc_scan_special(buf + i, n - i);
+    if (run > 0) {
+      size_t put = run;
+      if (!slipc_sink_put(sink, buf + i, &put)) {
+        *len = i;
+        return SLIPC_DECODER_IO_ERROR;
+      }
+      if (put == 0) {
+        break;
+      }
+      i += put;
+      self->prev = buf[i - 1];
+      if (put < run) {
+        break;
+      }
+    }
+
+    if (i == n) {
+      break;
+    }
+
+    self->prev = buf[i++];
+    if (self->prev == SLIPC_END) {
+      *len = i;
+      return SLIPC_DECODER_EOF;
+    }
+  }
+
+  *len = i;
+  return SLIPC_DECODER_MORE;
+}
+
+static slipc_decoder_result_t slipc_decode_span_table(slipc_decoder_t *self,
+                                                      slipc_sink_t *sink,
+                                                      uint8_t const *buf,
+                                                      size_t *len) {
+  size_t const n = *len;
+  size_t i = 0;
+  uint8_t prev = self->prev;
+  uint16_t flags = 0;
+  size_t invalid = 0;
+
+  while (i < n && (flags & SLIPC_TABLE_END) == 0) {
+    unsigned escaped = prev == SLIPC_ESC;
+
+    if (sink->len == 0) {
+      // Sink full, only bytes that write nothing can be consumed.
+      uint16_t entry = slipc_decode_table[escaped][buf[i]];
+      if (entry & SLIPC_TABLE_EMIT) {
+        break;
+      }
+      prev = buf[i++];
+      flags |= entry;
+      invalid += (entry & SLIPC_TABLE_MALFORMED) != 0;
+      continue;
+    }
+
+    // Every byte writes at most one byte, so this many always fit.
+    size_t const stop = n - i < sink->len ? n : i + sink->len;
+    uint8_t *out = sink->buf;
+
+    for (; i < stop; i++) {
+      prev = buf[i];
+      uint16_t entry = slipc_decode_table[escaped][prev];
+      *out = (uint8_t)(entry & SLIPC_TABLE_BYTE);
+      out += (entry & SLIPC_TABLE_EMIT) != 0;
+      escaped = (entry & SLIPC_TABLE_ESC) != 0;
+      flags |= entry;
+      invalid += (entry & SLIPC_TABLE_MALFORMED) != 0;
+
+      if (entry & SLIPC_TABLE_END) {
+        i++;
+        break;
+      }
+    }
+
+    sink->len -= (size_t)(out - sink->buf);
+    sink->buf = out;
+  }
+
+  self->prev = prev;
+  if (flags & SLIPC_TABLE_MALFORMED) {
+    self->malformed = true;
+  }
+  SLIPC_STAT_ADD(self->stats, invalid_escapes, invalid);
+
+  *len = i;
+  return flags & SLIPC_TABLE_END ? SLIPC_DECODER_EOF : SLIPC_DECODER_MORE;
+}
+
+#if SLIPC_ENABLE_TRACE
+/**
+ * \brief Read callback of a traced transfer.
+ */
+static slipc_io_reader_result_t
+slipc_trace_reader_read(slipc_io_user_ctx_t user_ctx, uint8_t *buf,
+                        size_t *len) {
+  slipc_trace_io_t *io = user_ctx.ctx;
+  uint64_t const start = SLIPC_TRACE_NOW();
+  slipc_io_reader_result_t res = slipc_io_reader_read(io->reader, buf, len);
+  uint64_t const now = SLIPC_TRACE_NOW();
+  slipc_trace_record(&io->trace->io_ns, now > start ? now - start : 0);
+  io->trace->reader_calls++;
+  return res;
+}
+
+/**
+ * \brief Write callback of a traced transfer.
+ */
+static slipc_io_writer_result_t
+slipc_trace_writer_write(slipc_io_user_ctx_t user_ctx, uint8_t const *buf,
+                         size_t *len) {
+  slipc_trace_io_t *io = user_ctx.ctx;
+  uint64_t const start = SLIPC_TRACE_NOW();
+  slipc_io_writer_result_t res = slipc_io_writer_write(io->writer, buf, len);
+  uint64_t const now = SLIPC_TRACE_NOW();
+  slipc_trace_record(&io->trace->io_ns, now > start ? now - start : 0);
+  io->trace->writer_calls++;
+  return res;
+}
+
+static void slipc_trace_begin(slipc_trace_io_t *io, slipc_trace_t *trace,
+                              slipc_io_reader_t **reader,
+                              slipc_io_writer_t **writer, size_t bytes_in) {
+  io->trace = trace;
+  io->reader = *reader;
+  io->writer = *writer;
+  io->traced_reader = (slipc_io_reader_t){.user_ctx = {io},
+                                         .read = slipc_trace_reader_read};
+  io->traced_writer = (slipc_io_writer_t){.user_ctx = {io},
+                                         .write = slipc_trace_writer_write};
+  io->bytes_in = bytes_in;
+  *reader = &io->traced_reader;
+  *writer = &io->traced_writer;
+  io->start = SLIPC_TRACE_NOW();
+}
+
+static void slipc_trace_end(slipc_trace_io_t *io, size_t bytes_in,
+                            bool frame_end, bool again) {
+  uint64_t const now = SLIPC_TRACE_NOW();
+  slipc_trace_t *trace = io->trace;
+
+  trace->pending_ns += now > io->start ? now - io->start : 0;
+  trace->pending_bytes += bytes_in - io->bytes_in;
+  if (again) {
+    return;
+  }
+
+  if (frame_end) {
+    slipc_trace_record(&trace->frame_ns, trace->pending_ns);
+    slipc_trace_record(&trace->frame_bytes, trace->pending_bytes);
   }
+  trace->pending_ns = 0;
+  trace->pending_bytes = 0;
 }
+#endif
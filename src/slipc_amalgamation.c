@@ -0,0 +1,24 @@
+/* SLIPC single translation unit build.
+ *
+ * Compiles slipc and slipc_io as one translation unit, so the compiler can
+ * inline the I/O wrappers and buffer callbacks into the encoder and decoder
+ * loops. Build this file instead of the individual sources, or enable
+ * SLIPC_AMALGAMATED in CMake.
+ *
+ * LICENSE: This library is released under the MIT License.
+ */
+// Define the POSIX feature macro, so they need to come first.
+#include "slipc_io_fd.c"
+#include "slipc_io_mmap.c"
+
+#include "slipc_io.c"
+
+#include "slipc_scan.c"
+#include "slipc_crc.c"
+#include "slipc_table.c"
+#include "slipc_trace.c"
+
+#include "slipc.c"
+#include "slipc_framer.c"
+#include "slipc_mux.c"
+#include "slipc_pool.c"
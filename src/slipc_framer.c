@@ -0,0 +1,127 @@
+/* SLIPC framer, delivers complete frames to a callback.
+ *
+ * LICENSE: This library is released under the MIT License.
+ */
+#include "slipc_framer.h"
+#include "slipc.h"
+#include "slipc_pool.h"
+#include "slipc_scan.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+void slipc_framer_init(slipc_framer_t *self, bool startbyte, uint8_t *buf,
+                       size_t size, slipc_framer_frame_cb on_frame,
+                       slipc_io_user_ctx_t user_ctx) {
+  assert(self);
+  assert(buf);
+  assert(on_frame);
+
+  slipc_decoder_init(&self->decoder, startbyte);
+  slipc_decoder_set_max_len(&self->decoder, size);
+  self->pool = NULL;
+  self->buf = buf;
+  self->size = size;
+  self->len = 0;
+  self->dropping = false;
+  self->user_ctx = user_ctx;
+  self->on_frame = on_frame;
+}
+
+void slipc_framer_init_pool(slipc_framer_t *self, bool startbyte,
+                            slipc_pool_t *pool, slipc_framer_frame_cb on_frame,
+                            slipc_io_user_ctx_t user_ctx) {
+  assert(self);
+  assert(pool);
+  assert(on_frame);
+
+  slipc_decoder_init(&self->decoder, startbyte);
+  slipc_decoder_set_max_len(&self->decoder, pool->frame_size);
+  self->pool = pool;
+  self->buf = NULL;
+  self->size = 0;
+  self->len = 0;
+  self->dropping = false;
+  self->user_ctx = user_ctx;
+  self->on_frame = on_frame;
+}
+
+void slipc_framer_deinit(slipc_framer_t *self) {
+  assert(self);
+
+  if (self->pool && self->buf) {
+    slipc_pool_release(self->pool, self->buf);
+    self->buf = NULL;
+    self->size = 0;
+  }
+}
+
+size_t slipc_framer_feed(slipc_framer_t *self, uint8_t const *buf,
+                         size_t len) {
+  assert(self);
+  assert(buf);
+
+  size_t frames = 0;
+
+  while (len > 0) {
+    if (self->dropping) {
+      // END always terminates a frame, no need to decode the rest.
+      size_t end = slipc_scan_end(buf, len);
+      if (end == len) {
+        break;
+      }
+      buf += end + 1;
+      len -= end + 1;
+
+      self->dropping = false;
+      self->decoder.prev = SLIPC_END;
+      self->decoder.in_frame = false;
+      continue;
+    }
+
+    if (self->pool && !self->buf) {
+      self->buf = slipc_pool_acquire(self->pool);
+      self->size = self->buf ? self->pool->frame_size : 0;
+    }
+
+    // Without a buffer the decoder still runs with no room, so the frame
+    // start is found before the frame is dropped.
+    uint8_t none;
+    uint8_t *out = self->buf ? self->buf + self->len : &none;
+    size_t in_len = len;
+    size_t out_len = self->size - self->len;
+    slipc_decoder_result_t res =
+        slipc_decoder_feed(&self->decoder, buf, &in_len, out, &out_len);
+    buf += in_len;
+    len -= in_len;
+    self->len += out_len;
+
+    if (res == SLIPC_DECODER_CRC_ERROR ||
+        (res == SLIPC_DECODER_EOF &&
+         (!self->buf || slipc_decoder_is_oversize(&self->decoder)))) {
+      // Dropped frame, the buffer is reused for the next one.
+      self->len = 0;
+    } else if (res == SLIPC_DECODER_EOF) {
+      // Checked already, only the payload goes to the callback.
+      size_t const crc_len = slipc_crc_size(self->decoder.crc_kind);
+      self->len = self->len > crc_len ? self->len - crc_len : 0;
+      uint8_t *frame = self->buf;
+      if (self->pool) {
+        // Ownership moves to the callback
+        self->buf = NULL;
+        self->size = 0;
+      }
+      self->on_frame(self->user_ctx, frame, self->len,
+                     self->decoder.malformed);
+      self->len = 0;
+      frames++;
+    } else if (res == SLIPC_DECODER_MORE && len > 0) {
+      // No buffer available
+      self->dropping = true;
+    }
+  }
+
+  return frames;
+}
@@ -1,6 +1,8 @@
 #include "slipc_io.h"
 
 #include <assert.h>
+#include <stdatomic.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <string.h>
@@ -54,16 +56,18 @@ slipc_array_writer_write(slipc_io_user_ctx_t user_ctx, uint8_t const *buf,
                          size_t *len) {
   slipc_io_buffer_writer_t *ctx = user_ctx.ctx;
 
-  *len = ctx->len < *len ? ctx->len : *len;
-  memcpy(ctx->buf, buf, *len);
+  if (ctx->len < *len) {
+    *len = ctx->len;
+    memcpy(ctx->buf, buf, *len);
+    ctx->len = 0;
+    ctx->buf += *len;
+    return SLIPC_IO_WRITER_EOF;
+  }
 
+  memcpy(ctx->buf, buf, *len);
   ctx->len -= *len;
   ctx->buf += *len;
 
-  if (ctx->len == 0) {
-    return SLIPC_IO_WRITER_EOF;
-  }
-
   return SLIPC_IO_WRITER_OK;
 }
 
@@ -88,3 +92,327 @@ slipc_io_writer_result_t slipc_io_writer_write(slipc_io_writer_t *writer,
   assert(writer);
   return writer->write(writer->user_ctx, data, len);
 }
+
+slipc_io_writer_result_t
+slipc_io_vec_writer_write(slipc_io_vec_writer_t *writer,
+                          const slipc_io_vec_t *vecs, size_t *count) {
+  assert(writer);
+  return writer->write(writer->user_ctx, vecs, count);
+}
+
+void slipc_io_ring_init(slipc_io_ring_t *self, uint8_t *buf, size_t size) {
+  assert(self);
+  assert(buf);
+  assert(size > 0 && (size & (size - 1)) == 0);
+
+  self->buf = buf;
+  self->size = size;
+  atomic_init(&self->head, 0);
+  atomic_init(&self->tail, 0);
+}
+
+uint8_t *slipc_io_ring_write_peek(slipc_io_ring_t *self, size_t *len) {
+  assert(self);
+  assert(len);
+
+  size_t head = atomic_load_explicit(&self->head, memory_order_relaxed);
+  size_t tail = atomic_load_explicit(&self->tail, memory_order_acquire);
+  size_t offset = head & (self->size - 1);
+  size_t space = self->size - (head - tail);
+  size_t contiguous = self->size - offset;
+
+  *len = space < contiguous ? space : contiguous;
+  return self->buf + offset;
+}
+
+void slipc_io_ring_write_commit(slipc_io_ring_t *self, size_t len) {
+  assert(self);
+
+  size_t head = atomic_load_explicit(&self->head, memory_order_relaxed);
+  atomic_store_explicit(&self->head, head + len, memory_order_release);
+}
+
+uint8_t const *slipc_io_ring_read_peek(slipc_io_ring_t *self, size_t *len) {
+  assert(self);
+  assert(len);
+
+  size_t tail = atomic_load_explicit(&self->tail, memory_order_relaxed);
+  size_t head = atomic_load_explicit(&self->head, memory_order_acquire);
+  size_t offset = tail & (self->size - 1);
+  size_t used = head - tail;
+  size_t contiguous = self->size - offset;
+
+  *len = used < contiguous ? used : contiguous;
+  return self->buf + offset;
+}
+
+void slipc_io_ring_read_commit(slipc_io_ring_t *self, size_t len) {
+  assert(self);
+
+  size_t tail = atomic_load_explicit(&self->tail, memory_order_relaxed);
+  atomic_store_explicit(&self->tail, tail + len, memory_order_release);
+}
+
+/**
+ * \brief Write callback for ring writer.
+ */
+static slipc_io_writer_result_t
+slipc_ring_writer_write(slipc_io_user_ctx_t user_ctx, uint8_t const *buf,
+                        size_t *len) {
+  slipc_io_ring_t *ring = user_ctx.ctx;
+  size_t written = 0;
+
+  // At most two rounds, before and after the wrap around.
+  for (int i = 0; i < 2 && written < *len; i++) {
+    size_t space;
+    uint8_t *dst = slipc_io_ring_write_peek(ring, &space);
+    size_t chunk = *len - written < space ? *len - written : space;
+    memcpy(dst, buf + written, chunk);
+    slipc_io_ring_write_commit(ring, chunk);
+    written += chunk;
+  }
+
+  if (written < *len) {
+    *len = written;
+    return SLIPC_IO_WRITER_EOF;
+  }
+  return SLIPC_IO_WRITER_OK;
+}
+
+slipc_io_writer_t slipc_io_writer_from_ring(slipc_io_ring_t *self) {
+  assert(self);
+
+  slipc_io_writer_t writer = {
+      .user_ctx = {self},
+      .write = slipc_ring_writer_write,
+  };
+  return writer;
+}
+
+/**
+ * \brief Read callback for ring reader.
+ */
+static slipc_io_reader_result_t
+slipc_ring_reader_read(slipc_io_user_ctx_t user_ctx, uint8_t *buf,
+                       size_t *len) {
+  slipc_io_ring_t *ring = user_ctx.ctx;
+  size_t read = 0;
+  size_t available = 0;
+
+  for (int i = 0; i < 2 && read < *len; i++) {
+    uint8_t const *src = slipc_io_ring_read_peek(ring, &available);
+    size_t chunk = *len - read < available ? *len - read : available;
+    memcpy(buf + read, src, chunk);
+    slipc_io_ring_read_commit(ring, chunk);
+    read += chunk;
+    available -= chunk;
+  }
+
+  // An empty ring is not the end of the stream, the producer may add more.
+  *len = read;
+  return read > 0 ? SLIPC_IO_READER_MORE : SLIPC_IO_READER_AGAIN;
+}
+
+slipc_io_reader_t slipc_io_reader_from_ring(slipc_io_ring_t *self) {
+  assert(self);
+
+  slipc_io_reader_t reader = {
+      .user_ctx = {self},
+      .read = slipc_ring_reader_read,
+  };
+  return reader;
+}
+
+/**
+ * \brief Flags of the DMA writer state.
+ */
+enum {
+  SLIPC_DMA_BUSY = 1, /**< A transfer is running */
+  SLIPC_DMA_LOCK = 2, /**< The buffer being filled is in use */
+};
+
+/**
+ * \brief SLIP END byte, slipc_io does not depend on slipc.h.
+ */
+static uint8_t const slipc_dma_end = 0xC0;
+
+/**
+ * \brief Take the lock on the buffer being filled.
+ *
+ * Only spins if the completion runs on another core at the same time.
+ */
+static void slipc_dma_lock(slipc_io_dma_writer_t *self) {
+  size_t state = atomic_load_explicit(&self->state, memory_order_relaxed);
+  do {
+    state &= ~(size_t)SLIPC_DMA_LOCK;
+  } while (!atomic_compare_exchange_weak_explicit(
+      &self->state, &state, state | SLIPC_DMA_LOCK, memory_order_acquire,
+      memory_order_relaxed));
+}
+
+/**
+ * \brief Hand the buffer being filled to the DMA and fill the other one.
+ *
+ * Needs the lock and no transfer running.
+ */
+static void slipc_dma_kick(slipc_io_dma_writer_t *self) {
+  uint8_t const *data = self->buf[self->fill];
+  size_t len = self->len;
+
+  self->fill ^= 1;
+  self->len = 0;
+  atomic_fetch_or_explicit(&self->state, SLIPC_DMA_BUSY, memory_order_relaxed);
+  self->start(self->user_ctx, data, len);
+}
+
+/**
+ * \brief Release the lock, starting a transfer if one is due.
+ *
+ * \param self DMA writer structure
+ * \param kick Start a transfer of a partly filled buffer
+ *
+ * \return Number of bytes left buffered
+ */
+static size_t slipc_dma_unlock(slipc_io_dma_writer_t *self, bool kick) {
+  size_t state = atomic_load_explicit(&self->state, memory_order_relaxed);
+  while (1) {
+    if (!(state & SLIPC_DMA_BUSY) && self->len > 0 &&
+        (kick || self->len == self->size)) {
+      slipc_dma_kick(self);
+      state = atomic_load_explicit(&self->state, memory_order_relaxed);
+      continue;
+    }
+
+    // Fails if a transfer completed meanwhile, so it is checked again.
+    size_t const left = self->len;
+    if (atomic_compare_exchange_weak_explicit(
+            &self->state, &state, state & ~(size_t)SLIPC_DMA_LOCK,
+            memory_order_release, memory_order_relaxed)) {
+      return left;
+    }
+  }
+}
+
+/**
+ * \brief Track the frame state over written bytes.
+ *
+ * \param self DMA writer structure
+ * \param buf Bytes written
+ * \param len Number of bytes written
+ *
+ * \return true if the bytes end with the END of a frame with data, not a
+ *         start byte or an empty frame
+ */
+static bool slipc_dma_frame_end(slipc_io_dma_writer_t *self, uint8_t const *buf,
+                                size_t len) {
+  if (len == 0) {
+    return false;
+  }
+
+  bool const open = len > 1 ? buf[len - 2] != slipc_dma_end : self->open;
+  self->open = buf[len - 1] != slipc_dma_end;
+  return !self->open && open;
+}
+
+/**
+ * \brief Write callback for DMA writer.
+ */
+static slipc_io_writer_result_t
+slipc_dma_writer_write(slipc_io_user_ctx_t user_ctx, uint8_t const *buf,
+                       size_t *len) {
+  slipc_io_dma_writer_t *ctx = user_ctx.ctx;
+  size_t const n = *len;
+  size_t done = 0;
+
+  slipc_dma_lock(ctx);
+  while (done < n) {
+    if (ctx->len == ctx->size) {
+      size_t state = atomic_load_explicit(&ctx->state, memory_order_relaxed);
+      if (state & SLIPC_DMA_BUSY) {
+        break;
+      }
+      slipc_dma_kick(ctx);
+    }
+
+    size_t const room = ctx->size - ctx->len;
+    size_t const part = n - done < room ? n - done : room;
+    memcpy(ctx->buf[ctx->fill] + ctx->len, buf + done, part);
+    ctx->len += part;
+    done += part;
+  }
+
+  // Send a finished frame right away, but not a lone start byte.
+  bool const end = slipc_dma_frame_end(ctx, buf, done);
+  slipc_dma_unlock(ctx, end);
+
+  *len = done;
+  return done == n ? SLIPC_IO_WRITER_OK : SLIPC_IO_WRITER_AGAIN;
+}
+
+slipc_io_writer_t slipc_io_writer_from_dma(slipc_io_dma_writer_t *self,
+                                            uint8_t *buf_a, uint8_t *buf_b,
+                                            size_t size,
+                                            slipc_io_dma_start_cb start,
+                                            slipc_io_user_ctx_t user_ctx) {
+  assert(self);
+  assert(buf_a);
+  assert(buf_b);
+  assert(size > 0);
+  assert(start);
+
+  self->buf[0] = buf_a;
+  self->buf[1] = buf_b;
+  self->size = size;
+  self->fill = 0;
+  self->len = 0;
+  self->open = false;
+  atomic_init(&self->state, 0);
+  self->user_ctx = user_ctx;
+  self->start = start;
+
+  slipc_io_writer_t writer = {
+      .user_ctx = {self},
+      .write = slipc_dma_writer_write,
+  };
+  return writer;
+}
+
+slipc_io_writer_result_t
+slipc_io_dma_writer_flush(slipc_io_dma_writer_t *self) {
+  assert(self);
+
+  slipc_dma_lock(self);
+  return slipc_dma_unlock(self, true) == 0 ? SLIPC_IO_WRITER_OK
+                                           : SLIPC_IO_WRITER_AGAIN;
+}
+
+void slipc_io_dma_writer_complete(slipc_io_dma_writer_t *self) {
+  assert(self);
+
+  size_t state = atomic_load_explicit(&self->state, memory_order_relaxed);
+  while (1) {
+    if (state & SLIPC_DMA_LOCK) {
+      // The writer sees the completed transfer when it unlocks.
+      if (atomic_compare_exchange_weak_explicit(
+              &self->state, &state, state & ~(size_t)SLIPC_DMA_BUSY,
+              memory_order_release, memory_order_relaxed)) {
+        return;
+      }
+      continue;
+    }
+
+    if (atomic_compare_exchange_weak_explicit(
+            &self->state, &state, state | SLIPC_DMA_LOCK,
+            memory_order_acquire, memory_order_relaxed)) {
+      break;
+    }
+  }
+
+  atomic_fetch_and_explicit(&self->state, ~(size_t)SLIPC_DMA_BUSY,
+                            memory_order_relaxed);
+  if (self->len > 0) {
+    slipc_dma_kick(self);
+  }
+  atomic_fetch_and_explicit(&self->state, ~(size_t)SLIPC_DMA_LOCK,
+                            memory_order_release);
+}
@@ -0,0 +1,264 @@
+/* SLIPC I/O on file descriptors.
+ *
+ * LICENSE: This library is released under the MIT License.
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include "slipc_io.h"
+
+#if SLIPC_IO_FD
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+/**
+ * \brief SLIP END byte, slipc_io does not depend on slipc.h.
+ */
+static uint8_t const slipc_fd_end = 0xC0;
+
+/**
+ * \brief Read once from a file descriptor, retrying on signals.
+ *
+ * \param fd File descriptor
+ * \param buf Buffer for reading data
+ * \param len Size of the buffer, set to the number of bytes read
+ *
+ * \retval SLIPC_IO_READER_MORE Data read
+ * \retval SLIPC_IO_READER_EOF End of file
+ * \retval SLIPC_IO_READER_AGAIN Non-blocking descriptor has no data
+ * \retval SLIPC_IO_READER_ERROR Error occurred
+ */
+static slipc_io_reader_result_t slipc_fd_read_some(int fd, uint8_t *buf,
+                                                   size_t *len);
+
+/**
+ * \brief Write once to a file descriptor, retrying on signals.
+ *
+ * \param fd File descriptor
+ * \param buf Data to write
+ * \param len Length of the data, set to the number of bytes written
+ *
+ * \retval SLIPC_IO_WRITER_OK Some data written
+ * \retval SLIPC_IO_WRITER_AGAIN Non-blocking descriptor is full
+ * \retval SLIPC_IO_WRITER_ERROR Error occurred
+ */
+static slipc_io_writer_result_t slipc_fd_write_some(int fd, uint8_t const *buf,
+                                                    size_t *len);
+
+/**
+ * \brief Track the frame state over written bytes.
+ *
+ * \param self Pointer to the fd writer structure
+ * \param buf Bytes written
+ * \param len Number of bytes written
+ *
+ * \return true if the bytes end with the END of a frame with data, not a
+ *         start byte or an empty frame
+ */
+static bool slipc_fd_frame_end(slipc_io_fd_writer_t *self, uint8_t const *buf,
+                               size_t len);
+
+/**
+ * \brief Read callback for fd reader.
+ */
+static slipc_io_reader_result_t
+slipc_fd_reader_read(slipc_io_user_ctx_t user_ctx, uint8_t *buf, size_t *len) {
+  slipc_io_fd_reader_t *ctx = user_ctx.ctx;
+
+  if (ctx->pos == ctx->len) {
+    if (*len >= ctx->size) {
+      // Nothing to batch, skip the copy.
+      return slipc_fd_read_some(ctx->fd, buf, len);
+    }
+
+    size_t got = ctx->size;
+    slipc_io_reader_result_t res = slipc_fd_read_some(ctx->fd, ctx->buf, &got);
+    ctx->pos = 0;
+    ctx->len = got;
+    if (res != SLIPC_IO_READER_MORE) {
+      *len = 0;
+      return res;
+    }
+  }
+
+  size_t const avail = ctx->len - ctx->pos;
+  *len = avail < *len ? avail : *len;
+  memcpy(buf, ctx->buf + ctx->pos, *len);
+  ctx->pos += *len;
+  return SLIPC_IO_READER_MORE;
+}
+
+slipc_io_reader_t slipc_io_reader_from_fd(slipc_io_fd_reader_t *self, int fd,
+                                           uint8_t *buf, size_t size) {
+  assert(self);
+  assert(buf);
+  assert(size > 0);
+
+  self->fd = fd;
+  self->buf = buf;
+  self->size = size;
+  self->pos = 0;
+  self->len = 0;
+
+  return (slipc_io_reader_t){.user_ctx = {self},
+                             .read = slipc_fd_reader_read};
+}
+
+/**
+ * \brief Write callback for fd writer.
+ */
+static slipc_io_writer_result_t
+slipc_fd_writer_write(slipc_io_user_ctx_t user_ctx, uint8_t const *buf,
+                      size_t *len) {
+  slipc_io_fd_writer_t *ctx = user_ctx.ctx;
+  size_t const n = *len;
+  size_t done = 0;
+
+  while (done < n) {
+    if (ctx->len == ctx->size) {
+      slipc_io_writer_result_t res = slipc_io_fd_writer_flush(ctx);
+      if (res != SLIPC_IO_WRITER_OK) {
+        slipc_fd_frame_end(ctx, buf, done);
+        *len = done;
+        return res;
+      }
+    }
+
+    if (ctx->len == 0 && n - done >= ctx->size) {
+      // Nothing to coalesce with, skip the copy.
+      size_t written = n - done;
+      slipc_io_writer_result_t res =
+          slipc_fd_write_some(ctx->fd, buf + done, &written);
+      done += written;
+      if (res == SLIPC_IO_WRITER_ERROR) {
+        slipc_fd_frame_end(ctx, buf, done);
+        *len = done;
+        return res;
+      }
+      if (res == SLIPC_IO_WRITER_OK) {
+        continue;
+      }
+      // Would block, take what fits into the buffer instead.
+    }
+
+    size_t const room = ctx->size - ctx->len;
+    size_t const part = n - done < room ? n - done : room;
+    memcpy(ctx->buf + ctx->len, buf + done, part);
+    ctx->len += part;
+    done += part;
+  }
+
+  if (slipc_fd_frame_end(ctx, buf, n) && ctx->len > 0) {
+    // End of a frame. If the descriptor would block, the frame stays
+    // buffered for the next write or flush.
+    if (slipc_io_fd_writer_flush(ctx) == SLIPC_IO_WRITER_ERROR) {
+      return SLIPC_IO_WRITER_ERROR;
+    }
+  }
+
+  return SLIPC_IO_WRITER_OK;
+}
+
+slipc_io_writer_t slipc_io_writer_from_fd(slipc_io_fd_writer_t *self, int fd,
+                                           uint8_t *buf, size_t size) {
+  assert(self);
+  assert(buf);
+  assert(size > 0);
+
+  self->fd = fd;
+  self->buf = buf;
+  self->size = size;
+  self->len = 0;
+  self->open = false;
+
+  return (slipc_io_writer_t){.user_ctx = {self},
+                             .write = slipc_fd_writer_write};
+}
+
+slipc_io_writer_result_t slipc_io_fd_writer_flush(slipc_io_fd_writer_t *self) {
+  assert(self);
+
+  slipc_io_writer_result_t res = SLIPC_IO_WRITER_OK;
+  size_t pos = 0;
+  while (pos < self->len) {
+    size_t written = self->len - pos;
+    res = slipc_fd_write_some(self->fd, self->buf + pos, &written);
+    pos += written;
+    if (res != SLIPC_IO_WRITER_OK) {
+      break;
+    }
+  }
+
+  // Keep the rest at the front, so the buffer fills up again.
+  memmove(self->buf, self->buf + pos, self->len - pos);
+  self->len -= pos;
+  return res;
+}
+
+bool slipc_io_fd_set_nonblocking(int fd, bool nonblocking) {
+  int flags = fcntl(fd, F_GETFL);
+  if (flags < 0) {
+    return false;
+  }
+
+  flags = nonblocking ? flags | O_NONBLOCK : flags & ~O_NONBLOCK;
+  return fcntl(fd, F_SETFL, flags) == 0;
+}
+
+static slipc_io_reader_result_t slipc_fd_read_some(int fd, uint8_t *buf,
+                                                   size_t *len) {
+  while (1) {
+    ssize_t got = read(fd, buf, *len);
+    if (got > 0) {
+      *len = (size_t)got;
+      return SLIPC_IO_READER_MORE;
+    }
+
+    *len = 0;
+    if (got == 0) {
+      return SLIPC_IO_READER_EOF;
+    }
+    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      return SLIPC_IO_READER_AGAIN;
+    }
+    if (errno != EINTR) {
+      return SLIPC_IO_READER_ERROR;
+    }
+  }
+}
+
+static slipc_io_writer_result_t slipc_fd_write_some(int fd, uint8_t const *buf,
+                                                    size_t *len) {
+  while (1) {
+    ssize_t written = write(fd, buf, *len);
+    if (written > 0) {
+      *len = (size_t)written;
+      return SLIPC_IO_WRITER_OK;
+    }
+
+    *len = 0;
+    if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      return SLIPC_IO_WRITER_AGAIN;
+    }
+    if (written == 0 || errno != EINTR) {
+      return SLIPC_IO_WRITER_ERROR;
+    }
+  }
+}
+
+static bool slipc_fd_frame_end(slipc_io_fd_writer_t *self, uint8_t const *buf,
+                               size_t len) {
+  if (len == 0) {
+    return false;
+  }
+
+  bool const open = len > 1 ? buf[len - 2] != slipc_fd_end : self->open;
+  self->open = buf[len - 1] != slipc_fd_end;
+  return !self->open && open;
+}
+#endif
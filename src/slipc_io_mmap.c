@@ -0,0 +1,144 @@
+/* SLIPC I/O on memory mapped files.
+ *
+ * LICENSE: This library is released under the MIT License.
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include "slipc_io.h"
+
+#if SLIPC_IO_MMAP
+#include <assert.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * \brief Read callback for a file that could not be mapped.
+ */
+static slipc_io_reader_result_t
+slipc_mmap_reader_error(slipc_io_user_ctx_t user_ctx, uint8_t *buf,
+                        size_t *len) {
+  (void)user_ctx;
+  (void)buf;
+  *len = 0;
+  return SLIPC_IO_READER_ERROR;
+}
+
+/**
+ * \brief Write callback for a file that could not be mapped.
+ */
+static slipc_io_writer_result_t
+slipc_mmap_writer_error(slipc_io_user_ctx_t user_ctx, uint8_t const *buf,
+                        size_t *len) {
+  (void)user_ctx;
+  (void)buf;
+  *len = 0;
+  return SLIPC_IO_WRITER_ERROR;
+}
+
+slipc_io_reader_t slipc_io_reader_from_mmap(slipc_io_mmap_reader_t *self,
+                                             char const *path) {
+  assert(self);
+  assert(path);
+
+  static uint8_t const empty = 0;
+  self->map = NULL;
+  self->map_len = 0;
+
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return (slipc_io_reader_t){.user_ctx = {self},
+                               .read = slipc_mmap_reader_error};
+  }
+
+  struct stat st;
+  bool const stat_ok = fstat(fd, &st) == 0;
+  void *map = MAP_FAILED;
+  if (stat_ok && st.st_size > 0) {
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  close(fd);
+
+  if (map == MAP_FAILED) {
+    if (stat_ok && st.st_size == 0) {
+      // Nothing to map, but a valid empty file.
+      return slipc_io_reader_from_buffer(&self->buffer, &empty, 0);
+    }
+    return (slipc_io_reader_t){.user_ctx = {self},
+                               .read = slipc_mmap_reader_error};
+  }
+
+  // Let the kernel read ahead, captures are read front to back.
+  posix_madvise(map, (size_t)st.st_size, POSIX_MADV_SEQUENTIAL);
+
+  self->map = map;
+  self->map_len = (size_t)st.st_size;
+  return slipc_io_reader_from_buffer(&self->buffer, self->map, self->map_len);
+}
+
+void slipc_io_mmap_reader_close(slipc_io_mmap_reader_t *self) {
+  assert(self);
+
+  if (self->map) {
+    munmap((void *)self->map, self->map_len);
+    self->map = NULL;
+    self->map_len = 0;
+  }
+}
+
+slipc_io_writer_t slipc_io_writer_from_mmap(slipc_io_mmap_writer_t *self,
+                                             char const *path,
+                                             size_t capacity) {
+  assert(self);
+  assert(path);
+
+  self->map = NULL;
+  self->map_len = 0;
+  self->fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0666);
+  if (self->fd < 0) {
+    return (slipc_io_writer_t){.user_ctx = {self},
+                               .write = slipc_mmap_writer_error};
+  }
+
+  void *map = MAP_FAILED;
+  if (capacity > 0 && ftruncate(self->fd, (off_t)capacity) == 0) {
+    map = mmap(NULL, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, self->fd,
+               0);
+  }
+
+  if (map == MAP_FAILED) {
+    close(self->fd);
+    self->fd = -1;
+    return (slipc_io_writer_t){.user_ctx = {self},
+                               .write = slipc_mmap_writer_error};
+  }
+
+  self->map = map;
+  self->map_len = capacity;
+  return slipc_io_writer_from_buffer(&self->buffer, self->map, self->map_len);
+}
+
+bool slipc_io_mmap_writer_close(slipc_io_mmap_writer_t *self) {
+  assert(self);
+
+  if (self->fd < 0) {
+    return false;
+  }
+
+  bool ok = true;
+  size_t written = self->map_len - self->buffer.len;
+  if (self->map) {
+    ok = msync(self->map, self->map_len, MS_SYNC) == 0;
+    munmap(self->map, self->map_len);
+    self->map = NULL;
+  }
+  ok = ftruncate(self->fd, (off_t)written) == 0 && ok;
+  ok = close(self->fd) == 0 && ok;
+  self->fd = -1;
+  return ok;
+}
+#endif
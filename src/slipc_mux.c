@@ -0,0 +1,209 @@
+/* SLIPC channel manager, decodes many serial channels at once.
+ *
+ * LICENSE: This library is released under the MIT License.
+ */
+#include "slipc_mux.h"
+#include "slipc.h"
+#include "slipc_crc.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** \brief Flag: the current frame is malformed. */
+#define SLIPC_MUX_MALFORMED 0x01
+/** \brief Flag: inside a frame. */
+#define SLIPC_MUX_IN_FRAME 0x02
+/** \brief Flag: the current frame exceeded the frame size. */
+#define SLIPC_MUX_OVERSIZE 0x04
+
+/**
+ * \brief Place the channel arrays in an arena.
+ *
+ * Arrays are placed by falling alignment, so none of them needs padding.
+ *
+ * \param self Pointer to the channel manager structure, NULL to only compute
+ *             the size
+ * \param channels Number of channels
+ * \param frame_size Size of each frame buffer
+ * \param arena Arena, ignored without self
+ *
+ * \return Number of bytes used
+ */
+static size_t slipc_mux_layout(slipc_mux_t *self, size_t channels,
+                               size_t frame_size, uint8_t *arena);
+
+/**
+ * \brief Load the state of a channel into the decoder.
+ *
+ * \param self Pointer to the channel manager structure
+ * \param channel Channel
+ */
+static inline void slipc_mux_load(slipc_mux_t *self, size_t channel);
+
+/**
+ * \brief Store the decoder state back to a channel.
+ *
+ * \param self Pointer to the channel manager structure
+ * \param channel Channel
+ */
+static inline void slipc_mux_store(slipc_mux_t *self, size_t channel);
+
+size_t slipc_mux_arena_size(size_t channels, size_t frame_size) {
+  return slipc_mux_layout(NULL, channels, frame_size, NULL);
+}
+
+void slipc_mux_init(slipc_mux_t *self, bool startbyte, size_t channels,
+                    size_t frame_size, void *arena, size_t arena_len) {
+  assert(self);
+  assert(arena);
+  assert(((uintptr_t)arena % _Alignof(slipc_mux_handler_t)) == 0);
+  assert(((uintptr_t)arena % _Alignof(size_t)) == 0);
+  assert(frame_size > 0 && frame_size <= UINT32_MAX);
+  assert(arena_len >= slipc_mux_arena_size(channels, frame_size));
+  (void)arena_len;
+
+  slipc_decoder_init(&self->decoder, startbyte);
+  slipc_decoder_set_max_len(&self->decoder, frame_size);
+  self->channels = channels;
+  self->frame_size = frame_size;
+  slipc_mux_layout(self, channels, frame_size, arena);
+
+  for (size_t i = 0; i < channels; i++) {
+    self->handlers[i] = (slipc_mux_handler_t){.on_frame = NULL};
+    self->frames[i] = 0;
+    self->dropped[i] = 0;
+    slipc_mux_reset(self, i);
+  }
+}
+
+void slipc_mux_set_crc(slipc_mux_t *self, slipc_crc_kind_t kind) {
+  assert(self);
+  slipc_decoder_set_crc(&self->decoder, kind);
+}
+
+void slipc_mux_set_handler(slipc_mux_t *self, size_t channel,
+                           slipc_framer_frame_cb on_frame,
+                           slipc_io_user_ctx_t user_ctx) {
+  assert(self);
+  assert(channel < self->channels);
+
+  self->handlers[channel].on_frame = on_frame;
+  self->handlers[channel].user_ctx = user_ctx;
+}
+
+void slipc_mux_reset(slipc_mux_t *self, size_t channel) {
+  assert(self);
+  assert(channel < self->channels);
+
+  self->prev[channel] = SLIPC_END;
+  self->flags[channel] = 0;
+  self->frame_len[channel] = 0;
+  self->crc[channel] = 0;
+}
+
+size_t slipc_mux_feed(slipc_mux_t *self, size_t channel, uint8_t const *buf,
+                      size_t len) {
+  assert(self);
+  assert(buf);
+  assert(channel < self->channels);
+
+  slipc_decoder_t *const decoder = &self->decoder;
+  uint8_t *const frame = self->bufs + channel * self->frame_size;
+  size_t const crc_len = slipc_crc_size(decoder->crc_kind);
+  size_t frames = 0;
+
+  slipc_mux_load(self, channel);
+
+  while (len > 0) {
+    // The decoder starts the next frame at the beginning of the buffer.
+    size_t const pos = decoder->in_frame ? decoder->frame_len : 0;
+    size_t in_len = len;
+    size_t out_len = self->frame_size - pos;
+    slipc_decoder_result_t res =
+        slipc_decoder_feed(decoder, buf, &in_len, frame + pos, &out_len);
+    buf += in_len;
+    len -= in_len;
+
+    if (res == SLIPC_DECODER_CRC_ERROR ||
+        (res == SLIPC_DECODER_EOF && decoder->oversize)) {
+      self->dropped[channel]++;
+    } else if (res == SLIPC_DECODER_EOF) {
+      // Checked already, only the payload goes to the callback.
+      size_t const n =
+          decoder->frame_len > crc_len ? decoder->frame_len - crc_len : 0;
+      slipc_mux_handler_t const *handler = &self->handlers[channel];
+      if (handler->on_frame) {
+        handler->on_frame(handler->user_ctx, frame, n, decoder->malformed);
+      }
+      self->frames[channel]++;
+      frames++;
+    }
+  }
+
+  slipc_mux_store(self, channel);
+  return frames;
+}
+
+size_t slipc_mux_feed_batch(slipc_mux_t *self, slipc_mux_input_t const *inputs,
+                            size_t count) {
+  assert(self);
+  assert(inputs || count == 0);
+
+  size_t frames = 0;
+  for (size_t i = 0; i < count; i++) {
+    frames += slipc_mux_feed(self, inputs[i].channel, inputs[i].buf,
+                             inputs[i].len);
+  }
+  return frames;
+}
+
+static size_t slipc_mux_layout(slipc_mux_t *self, size_t channels,
+                               size_t frame_size, uint8_t *arena) {
+  size_t const handlers = 0;
+  size_t const frames = handlers + channels * sizeof(slipc_mux_handler_t);
+  size_t const dropped = frames + channels * sizeof(size_t);
+  size_t const frame_len = dropped + channels * sizeof(size_t);
+  size_t const crc = frame_len + channels * sizeof(uint32_t);
+  size_t const prev = crc + channels * sizeof(uint32_t);
+  size_t const flags = prev + channels;
+  size_t const bufs = flags + channels;
+
+  if (self) {
+    self->handlers = (slipc_mux_handler_t *)(void *)(arena + handlers);
+    self->frames = (size_t *)(void *)(arena + frames);
+    self->dropped = (size_t *)(void *)(arena + dropped);
+    self->frame_len = (uint32_t *)(void *)(arena + frame_len);
+    self->crc = (uint32_t *)(void *)(arena + crc);
+    self->prev = arena + prev;
+    self->flags = arena + flags;
+    self->bufs = arena + bufs;
+  }
+  return bufs + channels * frame_size;
+}
+
+static inline void slipc_mux_load(slipc_mux_t *self, size_t channel) {
+  slipc_decoder_t *const decoder = &self->decoder;
+  uint8_t const flags = self->flags[channel];
+
+  decoder->prev = self->prev[channel];
+  decoder->malformed = (flags & SLIPC_MUX_MALFORMED) != 0;
+  decoder->in_frame = (flags & SLIPC_MUX_IN_FRAME) != 0;
+  decoder->oversize = (flags & SLIPC_MUX_OVERSIZE) != 0;
+  decoder->frame_len = self->frame_len[channel];
+  decoder->crc = self->crc[channel];
+}
+
+static inline void slipc_mux_store(slipc_mux_t *self, size_t channel) {
+  slipc_decoder_t const *const decoder = &self->decoder;
+
+  self->prev[channel] = decoder->prev;
+  uint8_t flags = 0;
+  flags |= decoder->malformed ? SLIPC_MUX_MALFORMED : 0;
+  flags |= decoder->in_frame ? SLIPC_MUX_IN_FRAME : 0;
+  flags |= decoder->oversize ? SLIPC_MUX_OVERSIZE : 0;
+  self->flags[channel] = flags;
+  self->frame_len[channel] = (uint32_t)decoder->frame_len;
+  self->crc[channel] = decoder->crc;
+}
@@ -0,0 +1,209 @@
+/* SLIPC parallel decoder for recorded captures.
+ *
+ * LICENSE: This library is released under the MIT License.
+ */
+#include "slipc_parallel.h"
+#include "slipc.h"
+#include "slipc_scan.h"
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * \brief Part of the capture decoded by one thread.
+ */
+typedef struct slipc_parallel_part {
+  uint8_t const *buf;         /**< Capture */
+  size_t start;               /**< Start of the part, right after an END */
+  size_t end;                 /**< End of the part, right after an END */
+  uint8_t *out;               /**< Output buffer */
+  bool decode;                /**< Decode the frames instead of counting */
+  slipc_frame_desc_t *frames; /**< Descriptors of this part */
+  size_t limit;               /**< Maximum number of frames to decode */
+  size_t count;               /**< Number of frames found */
+  size_t consumed;            /**< End of the last frame */
+} slipc_parallel_part_t;
+
+/**
+ * \brief Count the non empty frames of a part.
+ *
+ * \param part Part structure
+ */
+static void slipc_parallel_count(slipc_parallel_part_t *part);
+
+/**
+ * \brief Decode up to limit non empty frames of a part.
+ *
+ * \param part Part structure
+ */
+static void slipc_parallel_decode(slipc_parallel_part_t *part);
+
+/**
+ * \brief Thread entry, counts or decodes a part.
+ *
+ * \param arg Part structure
+ *
+ * \return NULL
+ */
+static void *slipc_parallel_run(void *arg);
+
+/**
+ * \brief Run one part per thread and wait for all of them.
+ *
+ * Falls back to the calling thread if a thread can't be created.
+ *
+ * \param parts Array of parts
+ * \param count Number of parts
+ */
+static void slipc_parallel_run_all(slipc_parallel_part_t *parts, size_t count);
+
+slipc_decoder_result_t slipc_decode_parallel(uint8_t const *buf, size_t *len,
+                                             uint8_t *out,
+                                             slipc_frame_desc_t *frames,
+                                             size_t *frame_count,
+                                             unsigned threads) {
+  assert(buf);
+  assert(len);
+  assert(out);
+  assert(frame_count);
+  assert(frames || *frame_count == 0);
+  assert(threads > 0 && threads <= SLIPC_PARALLEL_MAX_THREADS);
+
+  size_t const n = *len;
+  slipc_parallel_part_t parts[SLIPC_PARALLEL_MAX_THREADS];
+  size_t part_count = 0;
+
+  // Split near equal sizes, each part ends right after an END.
+  size_t start = 0;
+  for (unsigned i = 0; i < threads && start < n; i++) {
+    size_t target = n / threads * (i + 1);
+    size_t end = n;
+    if (i + 1 < threads) {
+      size_t from = target > start ? target : start;
+      size_t stop = from + slipc_scan_end(buf + from, n - from);
+      end = stop < n ? stop + 1 : n;
+    }
+
+    parts[part_count++] = (slipc_parallel_part_t){
+        .buf = buf,
+        .start = start,
+        .end = end,
+        .out = out,
+    };
+    start = end;
+  }
+
+  slipc_parallel_run_all(parts, part_count);
+
+  // Hand out descriptor slots in capture order.
+  size_t base = 0;
+  for (size_t i = 0; i < part_count; i++) {
+    size_t room = *frame_count - base;
+    parts[i].decode = true;
+    parts[i].frames = frames + base;
+    parts[i].limit = parts[i].count < room ? parts[i].count : room;
+    base += parts[i].limit;
+  }
+
+  slipc_parallel_run_all(parts, part_count);
+
+  slipc_decoder_result_t res = SLIPC_DECODER_MORE;
+  size_t consumed = 0;
+  for (size_t i = 0; i < part_count; i++) {
+    consumed = parts[i].consumed;
+    if (parts[i].limit < parts[i].count) {
+      res = SLIPC_DECODER_EOF;
+      break;
+    }
+  }
+
+  *len = consumed;
+  *frame_count = base;
+  return res;
+}
+
+static void slipc_parallel_count(slipc_parallel_part_t *part) {
+  uint8_t const *buf = part->buf;
+  size_t pos = part->start;
+
+  part->count = 0;
+  while (pos < part->end) {
+    size_t end = pos + slipc_scan_end(buf + pos, part->end - pos);
+    if (end == part->end) {
+      break;
+    }
+    part->count += end > pos;
+    pos = end + 1;
+  }
+}
+
+static void slipc_parallel_decode(slipc_parallel_part_t *part) {
+  slipc_decoder_t decoder = slipc_decoder_new(false);
+  size_t pos = part->start;
+  size_t count = 0;
+
+  part->consumed = pos;
+  while (pos < part->end) {
+    if (count == part->limit && part->buf[pos] != SLIPC_END) {
+      // Only empty frames may follow the last frame of the part.
+      break;
+    }
+
+    // Decoded data is never longer than encoded, writing at the input offset
+    // keeps parts and frames from overlapping.
+    size_t in_len = part->end - pos;
+    size_t out_len = in_len;
+    slipc_decoder_result_t res = slipc_decoder_feed_nosb(
+        &decoder, part->buf + pos, &in_len, part->out + pos, &out_len);
+    if (res != SLIPC_DECODER_EOF) {
+      break;
+    }
+
+    if (in_len > 1) {
+      part->frames[count++] = (slipc_frame_desc_t){
+          .offset = pos,
+          .len = out_len,
+          .malformed = decoder.malformed,
+      };
+    }
+    pos += in_len;
+    part->consumed = pos;
+  }
+}
+
+static void *slipc_parallel_run(void *arg) {
+  slipc_parallel_part_t *part = arg;
+  if (part->decode) {
+    slipc_parallel_decode(part);
+  } else {
+    slipc_parallel_count(part);
+  }
+  return NULL;
+}
+
+static void slipc_parallel_run_all(slipc_parallel_part_t *parts,
+                                   size_t count) {
+  pthread_t threads[SLIPC_PARALLEL_MAX_THREADS];
+  bool started[SLIPC_PARALLEL_MAX_THREADS];
+
+  for (size_t i = 1; i < count; i++) {
+    started[i] =
+        pthread_create(&threads[i], NULL, slipc_parallel_run, &parts[i]) == 0;
+    if (!started[i]) {
+      slipc_parallel_run(&parts[i]);
+    }
+  }
+
+  if (count > 0) {
+    slipc_parallel_run(&parts[0]);
+  }
+
+  for (size_t i = 1; i < count; i++) {
+    if (started[i]) {
+      pthread_join(threads[i], NULL);
+    }
+  }
+}
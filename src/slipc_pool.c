@@ -0,0 +1,56 @@
+/* SLIPC frame pool.
+ *
+ * LICENSE: This library is released under the MIT License.
+ */
+#include "slipc_pool.h"
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+
+void slipc_pool_init(slipc_pool_t *self, void *arena, size_t arena_len,
+                     size_t frame_size) {
+  assert(self);
+  assert(arena);
+  assert(((uintptr_t)arena % _Alignof(slipc_pool_node_t)) == 0);
+
+  size_t const align = _Alignof(slipc_pool_node_t);
+  size_t stride = frame_size < sizeof(slipc_pool_node_t)
+                      ? sizeof(slipc_pool_node_t)
+                      : frame_size;
+  stride = (stride + align - 1) / align * align;
+
+  self->free = NULL;
+  self->frame_size = frame_size;
+  self->available = 0;
+
+  // Build the list back to front so frames are handed out in arena order.
+  size_t count = arena_len / stride;
+  uint8_t *base = arena;
+  for (size_t i = count; i > 0; i--) {
+    slipc_pool_release(self, base + (i - 1) * stride);
+  }
+}
+
+uint8_t *slipc_pool_acquire(slipc_pool_t *self) {
+  assert(self);
+
+  slipc_pool_node_t *node = self->free;
+  if (!node) {
+    return NULL;
+  }
+
+  self->free = node->next;
+  self->available--;
+  return (uint8_t *)node;
+}
+
+void slipc_pool_release(slipc_pool_t *self, uint8_t *frame) {
+  assert(self);
+  assert(frame);
+
+  slipc_pool_node_t *node = (slipc_pool_node_t *)(void *)frame;
+  node->next = self->free;
+  self->free = node;
+  self->available++;
+}
@@ -0,0 +1,492 @@
+/* SLIPC special byte scanning.
+ *
+ * LICENSE: This library is released under the MIT License.
+ */
+#include "slipc_scan.h"
+#include "slipc.h"
+#include "slipc_kernel.h"
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) ||            \
+    defined(_M_IX86)
+#include <immintrin.h>
+#define SLIPC_SCAN_X86 1
+#else
+#define SLIPC_SCAN_X86 0
+#endif
+
+#if defined(__ARM_NEON) && defined(__ARM_LITTLE_ENDIAN)
+#include <arm_neon.h>
+#define SLIPC_SCAN_NEON 1
+#if defined(__linux__) && defined(__aarch64__)
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#endif
+#else
+#define SLIPC_SCAN_NEON 0
+#endif
+
+/**
+ * \brief Build a kernel for an instruction set the baseline does not have.
+ *
+ * Only GCC and Clang can, other compilers get the kernels of the baseline.
+ */
+#if SLIPC_SCAN_X86 && (defined(__GNUC__) || defined(__clang__))
+#define SLIPC_SCAN_TARGET(isa) __attribute__((target(isa)))
+#define SLIPC_SCAN_DISPATCH 1
+#else
+#define SLIPC_SCAN_TARGET(isa)
+#define SLIPC_SCAN_DISPATCH 0
+#endif
+
+#if SLIPC_SCAN_X86 && (defined(__SSE2__) || defined(_M_X64))
+#define SLIPC_SCAN_SSE2 1
+#else
+#define SLIPC_SCAN_SSE2 0
+#endif
+
+#if SLIPC_SCAN_DISPATCH || defined(__AVX2__)
+#define SLIPC_SCAN_AVX2 1
+#else
+#define SLIPC_SCAN_AVX2 0
+#endif
+
+#if SLIPC_SCAN_DISPATCH || defined(__AVX512BW__)
+#define SLIPC_SCAN_AVX512 1
+#else
+#define SLIPC_SCAN_AVX512 0
+#endif
+
+/**
+ * \brief Functions of a kernel.
+ */
+typedef struct slipc_scan_ops {
+  slipc_kernel_t kernel; /**< Kernel */
+  bool decode_table;     /**< Decode into memory with the table kernel */
+  /** Find the first byte equal to a or b */
+  size_t (*scan2)(uint8_t const *buf, size_t len, uint8_t a, uint8_t b);
+  /** Count the bytes equal to a or b */
+  size_t (*count2)(uint8_t const *buf, size_t len, uint8_t a, uint8_t b);
+} slipc_scan_ops_t;
+
+/**
+ * \brief Check if the CPU runs a kernel that is built in.
+ *
+ * \param kernel Kernel
+ *
+ * \return true if supported
+ */
+static bool slipc_cpu_supports(slipc_kernel_t kernel);
+
+/**
+ * \brief Get the functions of the kernel in use, picking one on first use.
+ *
+ * \return Kernel functions
+ */
+static inline slipc_scan_ops_t const *slipc_scan_ops(void);
+
+/**
+ * \brief Index of the lowest set bit, value must not be zero.
+ */
+static inline unsigned slipc_ctz64(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+  return (unsigned)__builtin_ctzll(value);
+#else
+  unsigned n = 0;
+  while ((value & 1) == 0) {
+    value >>= 1;
+    n++;
+  }
+  return n;
+#endif
+}
+
+/**
+ * \brief Number of set bits.
+ */
+static inline unsigned slipc_popcount64(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+  return (unsigned)__builtin_popcountll(value);
+#else
+  unsigned n = 0;
+  for (; value != 0; value &= value - 1) {
+    n++;
+  }
+  return n;
+#endif
+}
+
+/**
+ * \brief Count bytes equal to a or b byte by byte.
+ */
+static inline size_t slipc_count2_scalar(uint8_t const *buf, size_t len,
+                                         uint8_t a, uint8_t b) {
+  size_t n = 0;
+  for (size_t i = 0; i < len; i++) {
+    n += buf[i] == a || buf[i] == b;
+  }
+  return n;
+}
+
+/**
+ * \brief Scan byte by byte for a or b.
+ */
+static inline size_t slipc_scan2_scalar(uint8_t const *buf, size_t len,
+                                        uint8_t a, uint8_t b) {
+  for (size_t i = 0; i < len; i++) {
+    if (buf[i] == a || buf[i] == b) {
+      return i;
+    }
+  }
+  return len;
+}
+
+#if SLIPC_SCAN_AVX512
+SLIPC_SCAN_TARGET("avx512bw")
+static size_t slipc_scan2_avx512(uint8_t const *buf, size_t len, uint8_t a,
+                                 uint8_t b) {
+  __m512i const va = _mm512_set1_epi8((char)a);
+  __m512i const vb = _mm512_set1_epi8((char)b);
+
+  size_t i = 0;
+  for (; i + 64 <= len; i += 64) {
+    __m512i v = _mm512_loadu_si512((void const *)(buf + i));
+    __mmask64 mask =
+        _mm512_cmpeq_epi8_mask(v, va) | _mm512_cmpeq_epi8_mask(v, vb);
+    if (mask != 0) {
+      return i + slipc_ctz64(mask);
+    }
+  }
+
+  if (i < len) {
+    // Masked load, bytes past the end are not touched.
+    __mmask64 const live = ((uint64_t)1 << (len - i)) - 1;
+    __m512i v = _mm512_maskz_loadu_epi8(live, buf + i);
+    __mmask64 mask = _mm512_mask_cmpeq_epi8_mask(live, v, va) |
+                     _mm512_mask_cmpeq_epi8_mask(live, v, vb);
+    if (mask != 0) {
+      return i + slipc_ctz64(mask);
+    }
+  }
+  return len;
+}
+
+SLIPC_SCAN_TARGET("avx512bw")
+static size_t slipc_count2_avx512(uint8_t const *buf, size_t len, uint8_t a,
+                                  uint8_t b) {
+  __m512i const va = _mm512_set1_epi8((char)a);
+  __m512i const vb = _mm512_set1_epi8((char)b);
+
+  size_t n = 0;
+  size_t i = 0;
+  for (; i + 64 <= len; i += 64) {
+    __m512i v = _mm512_loadu_si512((void const *)(buf + i));
+    n += slipc_popcount64(_mm512_cmpeq_epi8_mask(v, va) |
+                          _mm512_cmpeq_epi8_mask(v, vb));
+  }
+
+  if (i < len) {
+    __mmask64 const live = ((uint64_t)1 << (len - i)) - 1;
+    __m512i v = _mm512_maskz_loadu_epi8(live, buf + i);
+    n += slipc_popcount64(_mm512_mask_cmpeq_epi8_mask(live, v, va) |
+                          _mm512_mask_cmpeq_epi8_mask(live, v, vb));
+  }
+  return n;
+}
+#endif
+
+#if SLIPC_SCAN_AVX2
+SLIPC_SCAN_TARGET("avx2")
+static size_t slipc_scan2_avx2(uint8_t const *buf, size_t len, uint8_t a,
+                               uint8_t b) {
+  __m256i const va = _mm256_set1_epi8((char)a);
+  __m256i const vb = _mm256_set1_epi8((char)b);
+
+  size_t i = 0;
+  for (; i + 32 <= len; i += 32) {
+    __m256i v = _mm256_loadu_si256((__m256i const *)(buf + i));
+    __m256i m = _mm256_or_si256(_mm256_cmpeq_epi8(v, va),
+                                _mm256_cmpeq_epi8(v, vb));
+    uint32_t mask = (uint32_t)_mm256_movemask_epi8(m);
+    if (mask != 0) {
+      return i + slipc_ctz64(mask);
+    }
+  }
+  return i + slipc_scan2_scalar(buf + i, len - i, a, b);
+}
+
+SLIPC_SCAN_TARGET("avx2")
+static size_t slipc_count2_avx2(uint8_t const *buf, size_t len, uint8_t a,
+                                uint8_t b) {
+  __m256i const va = _mm256_set1_epi8((char)a);
+  __m256i const vb = _mm256_set1_epi8((char)b);
+
+  size_t n = 0;
+  size_t i = 0;
+  for (; i + 32 <= len; i += 32) {
+    __m256i v = _mm256_loadu_si256((__m256i const *)(buf + i));
+    __m256i m = _mm256_or_si256(_mm256_cmpeq_epi8(v, va),
+                                _mm256_cmpeq_epi8(v, vb));
+    n += slipc_popcount64((uint32_t)_mm256_movemask_epi8(m));
+  }
+  return n + slipc_count2_scalar(buf + i, len - i, a, b);
+}
+
+#endif
+
+#if SLIPC_SCAN_SSE2
+static size_t slipc_scan2_sse2(uint8_t const *buf, size_t len, uint8_t a,
+                               uint8_t b) {
+  __m128i const va = _mm_set1_epi8((char)a);
+  __m128i const vb = _mm_set1_epi8((char)b);
+
+  size_t i = 0;
+  for (; i + 16 <= len; i += 16) {
+    __m128i v = _mm_loadu_si128((__m128i const *)(buf + i));
+    __m128i m = _mm_or_si128(_mm_cmpeq_epi8(v, va), _mm_cmpeq_epi8(v, vb));
+    uint32_t mask = (uint32_t)_mm_movemask_epi8(m);
+    if (mask != 0) {
+      return i + slipc_ctz64(mask);
+    }
+  }
+  return i + slipc_scan2_scalar(buf + i, len - i, a, b);
+}
+
+static size_t slipc_count2_sse2(uint8_t const *buf, size_t len, uint8_t a,
+                                uint8_t b) {
+  __m128i const va = _mm_set1_epi8((char)a);
+  __m128i const vb = _mm_set1_epi8((char)b);
+
+  size_t n = 0;
+  size_t i = 0;
+  for (; i + 16 <= len; i += 16) {
+    __m128i v = _mm_loadu_si128((__m128i const *)(buf + i));
+    __m128i m = _mm_or_si128(_mm_cmpeq_epi8(v, va), _mm_cmpeq_epi8(v, vb));
+    n += slipc_popcount64((uint32_t)_mm_movemask_epi8(m));
+  }
+  return n + slipc_count2_scalar(buf + i, len - i, a, b);
+}
+
+#endif
+
+#if SLIPC_SCAN_NEON
+static size_t slipc_scan2_neon(uint8_t const *buf, size_t len, uint8_t a,
+                               uint8_t b) {
+  uint8x16_t const va = vdupq_n_u8(a);
+  uint8x16_t const vb = vdupq_n_u8(b);
+
+  size_t i = 0;
+  for (; i + 16 <= len; i += 16) {
+    uint8x16_t v = vld1q_u8(buf + i);
+    uint8x16_t m = vorrq_u8(vceqq_u8(v, va), vceqq_u8(v, vb));
+    // Narrow every byte of the compare result to a nibble of a 64-bit mask.
+    uint8x8_t n = vshrn_n_u16(vreinterpretq_u16_u8(m), 4);
+    uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(n), 0);
+    if (mask != 0) {
+      return i + slipc_ctz64(mask) / 4;
+    }
+  }
+  return i + slipc_scan2_scalar(buf + i, len - i, a, b);
+}
+
+static size_t slipc_count2_neon(uint8_t const *buf, size_t len, uint8_t a,
+                                uint8_t b) {
+  uint8x16_t const va = vdupq_n_u8(a);
+  uint8x16_t const vb = vdupq_n_u8(b);
+
+  size_t n = 0;
+  size_t i = 0;
+  for (; i + 16 <= len; i += 16) {
+    uint8x16_t v = vld1q_u8(buf + i);
+    uint8x16_t m = vorrq_u8(vceqq_u8(v, va), vceqq_u8(v, vb));
+    uint8x8_t nibbles = vshrn_n_u16(vreinterpretq_u16_u8(m), 4);
+    n += slipc_popcount64(vget_lane_u64(vreinterpret_u64_u8(nibbles), 0)) / 4;
+  }
+  return n + slipc_count2_scalar(buf + i, len - i, a, b);
+}
+
+#endif
+
+/**
+ * \brief Mark every zero byte of value with its high bit.
+ *
+ * Bytes above the first zero byte may be marked as well, the lowest marked
+ * byte is always exact.
+ */
+static inline uint64_t slipc_swar_zero(uint64_t value) {
+  uint64_t const ones = 0x0101010101010101ull;
+  uint64_t const highs = 0x8080808080808080ull;
+  return (value - ones) & ~value & highs;
+}
+
+static size_t slipc_scan2_swar(uint8_t const *buf, size_t len, uint8_t a,
+                               uint8_t b) {
+  uint64_t const ones = 0x0101010101010101ull;
+  uint64_t const pa = ones * a;
+  uint64_t const pb = ones * b;
+
+  size_t i = 0;
+  for (; i + 8 <= len; i += 8) {
+    uint64_t v;
+    memcpy(&v, buf + i, sizeof(v));
+    uint64_t mask = slipc_swar_zero(v ^ pa) | slipc_swar_zero(v ^ pb);
+    if (mask != 0) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+      return i + slipc_ctz64(mask) / 8;
+#else
+      return i + slipc_scan2_scalar(buf + i, 8, a, b);
+#endif
+    }
+  }
+  return i + slipc_scan2_scalar(buf + i, len - i, a, b);
+}
+
+/**
+ * \brief Mark exactly the zero bytes of value with their high bit.
+ */
+static inline uint64_t slipc_swar_zero_exact(uint64_t value) {
+  uint64_t const lows = 0x7F7F7F7F7F7F7F7Full;
+  return ~(((value & lows) + lows) | value) & ~lows;
+}
+
+static size_t slipc_count2_swar(uint8_t const *buf, size_t len, uint8_t a,
+                                uint8_t b) {
+  uint64_t const ones = 0x0101010101010101ull;
+  uint64_t const pa = ones * a;
+  uint64_t const pb = ones * b;
+
+  size_t n = 0;
+  size_t i = 0;
+  for (; i + 8 <= len; i += 8) {
+    uint64_t v;
+    memcpy(&v, buf + i, sizeof(v));
+    n += slipc_popcount64(slipc_swar_zero_exact(v ^ pa) |
+                          slipc_swar_zero_exact(v ^ pb));
+  }
+  return n + slipc_count2_scalar(buf + i, len - i, a, b);
+}
+
+/**
+ * \brief Kernels by slipc_kernel_t, NULL where not built in.
+ *
+ * The scalar kernel decodes with the table, skipping runs does not pay off
+ * there for short frames.
+ */
+static slipc_scan_ops_t const slipc_scan_kernels[SLIPC_KERNEL_COUNT] = {
+    [SLIPC_KERNEL_SCALAR] = {SLIPC_KERNEL_SCALAR, true, slipc_scan2_swar,
+                             slipc_count2_swar},
+#if SLIPC_SCAN_SSE2
+    [SLIPC_KERNEL_SSE2] = {SLIPC_KERNEL_SSE2, false, slipc_scan2_sse2,
+                           slipc_count2_sse2},
+#endif
+#if SLIPC_SCAN_AVX2
+    [SLIPC_KERNEL_AVX2] = {SLIPC_KERNEL_AVX2, false, slipc_scan2_avx2,
+                           slipc_count2_avx2},
+#endif
+#if SLIPC_SCAN_AVX512
+    [SLIPC_KERNEL_AVX512] = {SLIPC_KERNEL_AVX512, false, slipc_scan2_avx512,
+                             slipc_count2_avx512},
+#endif
+#if SLIPC_SCAN_NEON
+    [SLIPC_KERNEL_NEON] = {SLIPC_KERNEL_NEON, false, slipc_scan2_neon,
+                           slipc_count2_neon},
+#endif
+};
+
+/**
+ * \brief Kernel in use, NULL until the first scan or slipc_kernel_set().
+ *
+ * Points to constant data, so relaxed accesses are enough.
+ */
+static _Atomic(slipc_scan_ops_t const *) slipc_scan_current;
+
+size_t slipc_scan_special(uint8_t const *buf, size_t len) {
+  return slipc_scan_ops()->scan2(buf, len, SLIPC_END, SLIPC_ESC);
+}
+
+size_t slipc_scan_end(uint8_t const *buf, size_t len) {
+  return slipc_scan_ops()->scan2(buf, len, SLIPC_END, SLIPC_END);
+}
+
+size_t slipc_count_special(uint8_t const *buf, size_t len) {
+  return slipc_scan_ops()->count2(buf, len, SLIPC_END, SLIPC_ESC);
+}
+
+bool slipc_scan_decode_table(void) { return slipc_scan_ops()->decode_table; }
+
+slipc_kernel_t slipc_kernel_get(void) { return slipc_scan_ops()->kernel; }
+
+bool slipc_kernel_supported(slipc_kernel_t kernel) {
+  if (kernel <= SLIPC_KERNEL_AUTO || kernel >= SLIPC_KERNEL_COUNT ||
+      !slipc_scan_kernels[kernel].scan2) {
+    return false;
+  }
+  return slipc_cpu_supports(kernel);
+}
+
+bool slipc_kernel_set(slipc_kernel_t kernel) {
+  if (kernel == SLIPC_KERNEL_AUTO) {
+    // Widest first.
+    static slipc_kernel_t const order[] = {
+        SLIPC_KERNEL_AVX512, SLIPC_KERNEL_AVX2, SLIPC_KERNEL_SSE2,
+        SLIPC_KERNEL_NEON,   SLIPC_KERNEL_SCALAR,
+    };
+    for (size_t i = 0; i < sizeof(order) / sizeof(order[0]); i++) {
+      if (slipc_kernel_supported(order[i])) {
+        kernel = order[i];
+        break;
+      }
+    }
+  }
+
+  if (!slipc_kernel_supported(kernel)) {
+    return false;
+  }
+  atomic_store_explicit(&slipc_scan_current, &slipc_scan_kernels[kernel],
+                        memory_order_relaxed);
+  return true;
+}
+
+const char *slipc_kernel_name(slipc_kernel_t kernel) {
+  static char const *const names[SLIPC_KERNEL_COUNT] = {
+      [SLIPC_KERNEL_AUTO] = "auto",     [SLIPC_KERNEL_SCALAR] = "scalar",
+      [SLIPC_KERNEL_SSE2] = "sse2",     [SLIPC_KERNEL_AVX2] = "avx2",
+      [SLIPC_KERNEL_AVX512] = "avx512", [SLIPC_KERNEL_NEON] = "neon",
+  };
+  return kernel < SLIPC_KERNEL_COUNT ? names[kernel] : "unknown";
+}
+
+static bool slipc_cpu_supports(slipc_kernel_t kernel) {
+  switch (kernel) {
+#if SLIPC_SCAN_X86 && SLIPC_SCAN_DISPATCH
+  case SLIPC_KERNEL_AVX2:
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+  case SLIPC_KERNEL_AVX512:
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx512bw");
+#endif
+#if SLIPC_SCAN_NEON && defined(__linux__) && defined(__aarch64__)
+  case SLIPC_KERNEL_NEON:
+    return (getauxval(AT_HWCAP) & HWCAP_ASIMD) != 0;
+#endif
+  default:
+    // Part of the baseline the library is compiled for.
+    return true;
+  }
+}
+
+static inline slipc_scan_ops_t const *slipc_scan_ops(void) {
+  slipc_scan_ops_t const *ops =
+      atomic_load_explicit(&slipc_scan_current, memory_order_relaxed);
+  if (!ops) {
+    slipc_kernel_set(SLIPC_KERNEL_AUTO);
+    ops = atomic_load_explicit(&slipc_scan_current, memory_order_relaxed);
+  }
+  return ops;
+}
@@ -0,0 +1,56 @@
+/* SLIPC special byte scanning.
+ *
+ * Internal helpers used by the buffer paths of the encoder and decoder to skip
+ * over bytes that need no special treatment.
+ *
+ * The kernel is selected at run time, see slipc_kernel.h: AVX-512BW, AVX2 or
+ * SSE2 on x86, NEON on ARM and a portable 64-bit SWAR implementation
+ * everywhere.
+ *
+ * LICENSE: This library is released under the MIT License.
+ */
+#ifndef _SLIPC_SCAN_H_
+#define _SLIPC_SCAN_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * \brief Find the first SLIPC_END or SLIPC_ESC byte in a buffer.
+ *
+ * \param buf Pointer to the data buffer
+ * \param len Length of the data buffer
+ *
+ * \return Index of the first special byte, len if there is none
+ */
+size_t slipc_scan_special(uint8_t const *buf, size_t len);
+
+/**
+ * \brief Find the first SLIPC_END byte in a buffer.
+ *
+ * \param buf Pointer to the data buffer
+ * \param len Length of the data buffer
+ *
+ * \return Index of the first SLIPC_END byte, len if there is none
+ */
+size_t slipc_scan_end(uint8_t const *buf, size_t len);
+
+/**
+ * \brief Count the SLIPC_END and SLIPC_ESC bytes in a buffer.
+ *
+ * \param buf Pointer to the data buffer
+ * \param len Length of the data buffer
+ *
+ * \return Number of special bytes
+ */
+size_t slipc_count_special(uint8_t const *buf, size_t len);
+
+/**
+ * \brief Check if the kernel in use decodes into memory with the table.
+ *
+ * \return true for the table kernel, false for skipping runs with the scan
+ */
+bool slipc_scan_decode_table(void);
+
+#endif /* _SLIPC_SCAN_H_ */
@@ -0,0 +1,45 @@
+/* SLIPC decoder transition table.
+ *
+ * LICENSE: This library is released under the MIT License.
+ */
+#include "slipc_table.h"
+#include "slipc.h"
+
+#include <stdint.h>
+
+/**
+ * \brief Entry for byte b in the unescaped state.
+ */
+#define SLIPC_TABLE_PLAIN(b)                                                   \
+  ((b) == SLIPC_END   ? SLIPC_TABLE_END                                        \
+   : (b) == SLIPC_ESC ? SLIPC_TABLE_ESC                                        \
+                      : SLIPC_TABLE_EMIT | (b))
+
+/**
+ * \brief Entry for byte b following SLIPC_ESC.
+ *
+ * Malformed sequences keep the byte, matching slipc_decode_byte().
+ */
+#define SLIPC_TABLE_ESCAPED(b)                                                 \
+  ((b) == SLIPC_END       ? SLIPC_TABLE_END                                    \
+   : (b) == SLIPC_ESC_END ? SLIPC_TABLE_EMIT | SLIPC_END                       \
+   : (b) == SLIPC_ESC_ESC ? SLIPC_TABLE_EMIT | SLIPC_ESC                       \
+   : (b) == SLIPC_ESC                                                          \
+       ? SLIPC_TABLE_EMIT | SLIPC_TABLE_MALFORMED | SLIPC_TABLE_ESC | (b)      \
+       : SLIPC_TABLE_EMIT | SLIPC_TABLE_MALFORMED | (b))
+
+#define SLIPC_TABLE_4(f, b) f(b), f((b) + 1), f((b) + 2), f((b) + 3)
+#define SLIPC_TABLE_16(f, b)                                                   \
+  SLIPC_TABLE_4(f, b), SLIPC_TABLE_4(f, (b) + 4), SLIPC_TABLE_4(f, (b) + 8),   \
+      SLIPC_TABLE_4(f, (b) + 12)
+#define SLIPC_TABLE_64(f, b)                                                   \
+  SLIPC_TABLE_16(f, b), SLIPC_TABLE_16(f, (b) + 16),                           \
+      SLIPC_TABLE_16(f, (b) + 32), SLIPC_TABLE_16(f, (b) + 48)
+#define SLIPC_TABLE_256(f)                                                     \
+  SLIPC_TABLE_64(f, 0), SLIPC_TABLE_64(f, 64), SLIPC_TABLE_64(f, 128),         \
+      SLIPC_TABLE_64(f, 192)
+
+uint16_t const slipc_decode_table[2][256] = {
+    {SLIPC_TABLE_256(SLIPC_TABLE_PLAIN)},
+    {SLIPC_TABLE_256(SLIPC_TABLE_ESCAPED)},
+};
@@ -0,0 +1,26 @@
+/* SLIPC decoder transition table.
+ *
+ * Internal table driving the branch-light decoder kernel used on targets
+ * without SIMD. It is indexed by the escape state (previous byte was
+ * SLIPC_ESC) and the current byte. The row for the unescaped state doubles as
+ * byte classifier: every byte without SLIPC_TABLE_EMIT is special.
+ *
+ * LICENSE: This library is released under the MIT License.
+ */
+#ifndef _SLIPC_TABLE_H_
+#define _SLIPC_TABLE_H_
+
+#include <stdint.h>
+
+#define SLIPC_TABLE_BYTE 0x00FFu /**< Decoded byte */
+#define SLIPC_TABLE_EMIT 0x0100u /**< Decoded byte is written */
+#define SLIPC_TABLE_ESC 0x0200u  /**< Next byte is escaped */
+#define SLIPC_TABLE_MALFORMED 0x0400u /**< Invalid escape sequence */
+#define SLIPC_TABLE_END 0x0800u       /**< End of frame */
+
+/**
+ * \brief Decoder transition table, [escaped][byte].
+ */
+extern uint16_t const slipc_decode_table[2][256];
+
+#endif /* _SLIPC_TABLE_H_ */
@@ -0,0 +1,121 @@
+/* SLIPC tracing of frame latency and reader/writer calls.
+ *
+ * LICENSE: This library is released under the MIT License.
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include "slipc_trace.h"
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+/**
+ * \brief Get the histogram bucket of a value.
+ *
+ * \param value Value
+ *
+ * \return Number of significant bits, at most SLIPC_TRACE_BUCKETS - 1
+ */
+static unsigned slipc_trace_bucket(uint64_t value);
+
+uint64_t slipc_trace_now(void) {
+  struct timespec ts;
+  // Wall clock time jumps with NTP and settimeofday(), prefer a monotonic one.
+#if defined(CLOCK_MONOTONIC)
+  if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0) {
+    return 0;
+  }
+#elif defined(TIME_MONOTONIC)
+  if (timespec_get(&ts, TIME_MONOTONIC) != TIME_MONOTONIC) {
+    return 0;
+  }
+#else
+  if (timespec_get(&ts, TIME_UTC) != TIME_UTC) {
+    return 0;
+  }
+#endif
+  return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+void slipc_trace_record(slipc_trace_histogram_t *self, uint64_t value) {
+  assert(self);
+
+  self->count[slipc_trace_bucket(value)]++;
+  self->sum += value;
+  if (value > self->max) {
+    self->max = value;
+  }
+}
+
+size_t slipc_trace_count(slipc_trace_histogram_t const *self) {
+  assert(self);
+
+  size_t count = 0;
+  for (unsigned i = 0; i < SLIPC_TRACE_BUCKETS; i++) {
+    count += self->count[i];
+  }
+  return count;
+}
+
+uint64_t slipc_trace_percentile(slipc_trace_histogram_t const *self,
+                                unsigned permille) {
+  assert(self);
+  assert(permille <= 1000);
+
+  size_t const count = slipc_trace_count(self);
+  if (count == 0) {
+    return 0;
+  }
+
+  // Rank of the value, rounded up so any percentile above 0 finds one.
+  size_t rank = (size_t)(((uint64_t)count * permille + 999) / 1000);
+  rank = rank > 0 ? rank : 1;
+
+  size_t seen = 0;
+  for (unsigned i = 0; i < SLIPC_TRACE_BUCKETS - 1; i++) {
+    seen += self->count[i];
+    if (seen >= rank) {
+      uint64_t const upper = i ? ((uint64_t)1 << i) - 1 : 0;
+      return upper < self->max ? upper : self->max;
+    }
+  }
+  return self->max;
+}
+
+void slipc_trace_merge(slipc_trace_t *dst, slipc_trace_t const *src) {
+  assert(dst);
+  assert(src);
+
+  slipc_trace_histogram_t *const to[] = {&dst->frame_ns, &dst->frame_bytes,
+                                         &dst->io_ns};
+  slipc_trace_histogram_t const *const from[] = {
+      &src->frame_ns, &src->frame_bytes, &src->io_ns};
+
+  for (size_t h = 0; h < sizeof(to) / sizeof(to[0]); h++) {
+    for (unsigned i = 0; i < SLIPC_TRACE_BUCKETS; i++) {
+      to[h]->count[i] += from[h]->count[i];
+    }
+    to[h]->sum += from[h]->sum;
+    if (from[h]->max > to[h]->max) {
+      to[h]->max = from[h]->max;
+    }
+  }
+
+  dst->reader_calls += src->reader_calls;
+  dst->writer_calls += src->writer_calls;
+}
+
+static unsigned slipc_trace_bucket(uint64_t value) {
+  unsigned bits = 0;
+#if defined(__GNUC__) || defined(__clang__)
+  bits = value ? 64 - (unsigned)__builtin_clzll(value) : 0;
+#else
+  while (value) {
+    bits++;
+    value >>= 1;
+  }
+#endif
+  return bits < SLIPC_TRACE_BUCKETS ? bits : SLIPC_TRACE_BUCKETS - 1;
+}
@@ -2,12 +2,22 @@
 #include "catch2/generators/catch_generators.hpp"
 
 #include <algorithm>
+#include <filesystem>
 #include <cstdint>
+#include <random>
 #include <span>
+#include <string>
+#include <thread>
 #include <vector>
 
+#include <unistd.h>
+
 namespace dut {
 #include "slipc.h"
+#include "slipc_framer.h"
+#include "slipc_mux.h"
+#include "slipc_parallel.h"
+#include "slipc_pool.h"
 }
 
 struct InputDecode {
@@ -265,6 +275,7 @@ static const InputDecode MALFORMED_NOISY_PACKET = {
 struct VecWriter : dut::slipc_io_writer_t {
   std::vector<uint8_t> buf;
   dut::slipc_io_writer_result_t result;
+  size_t calls = 0;
 
   VecWriter(dut::slipc_io_writer_result_t result =
                 dut::slipc_io_writer_result_t::SLIPC_IO_WRITER_OK)
@@ -274,6 +285,7 @@ struct VecWriter : dut::slipc_io_writer_t {
   writer_cb(dut::slipc_io_user_ctx_t uctx, uint8_t const *buf, size_t *len) {
     auto &ctx = *static_cast<VecWriter *>(uctx.ctx);
     std::span src(buf, *len);
+    ctx.calls++;
 
     if (ctx.result == dut::slipc_io_writer_result_t::SLIPC_IO_WRITER_OK) {
       ctx.buf.insert(ctx.buf.end(), src.begin(), src.end());
@@ -286,9 +298,30 @@ struct VecWriter : dut::slipc_io_writer_t {
   }
 };
 
+struct VecVecWriter : dut::slipc_io_vec_writer_t {
+  std::vector<uint8_t> buf;
+  std::vector<dut::slipc_io_vec_t> vecs;
+  size_t calls = 0;
+
+  VecVecWriter() : dut::slipc_io_vec_writer_t{this, writer_cb} {}
+
+  static dut::slipc_io_writer_result_t
+  writer_cb(dut::slipc_io_user_ctx_t uctx, dut::slipc_io_vec_t const *vecs,
+            size_t *count) {
+    auto &ctx = *static_cast<VecVecWriter *>(uctx.ctx);
+    ctx.calls++;
+    for (auto const &vec : std::span(vecs, *count)) {
+      ctx.buf.insert(ctx.buf.end(), vec.data, vec.data + vec.len);
+      ctx.vecs.push_back(vec);
+    }
+    return dut::slipc_io_writer_result_t::SLIPC_IO_WRITER_OK;
+  }
+};
+
 struct VecReader : dut::slipc_io_reader_t {
   std::vector<uint8_t> buf;
   dut::slipc_io_reader_result_t result;
+  size_t calls = 0;
 
   VecReader(std::vector<uint8_t> buf,
             dut::slipc_io_reader_result_t result =
@@ -298,6 +331,7 @@ struct VecReader : dut::slipc_io_reader_t {
   static dut::slipc_io_reader_result_t reader_cb(dut::slipc_io_user_ctx_t uctx,
                                                  uint8_t *buf, size_t *len) {
     auto &ctx = *static_cast<VecReader *>(uctx.ctx);
+    ctx.calls++;
     std::span dst(buf, *len);
     if (ctx.result == dut::slipc_io_reader_result_t::SLIPC_IO_READER_MORE) {
       *len = std::min(ctx.buf.size(), dst.size_bytes());
@@ -313,6 +347,28 @@ struct VecReader : dut::slipc_io_reader_t {
   }
 };
 
+struct TrickleWriter : dut::slipc_io_writer_t {
+  std::vector<uint8_t> buf;
+  size_t budget;
+
+  TrickleWriter(size_t budget)
+      : dut::slipc_io_writer_t{this, writer_cb}, budget(budget) {}
+
+  // Takes budget bytes in total, like a congested socket.
+  static dut::slipc_io_writer_result_t
+  writer_cb(dut::slipc_io_user_ctx_t uctx, uint8_t const *buf, size_t *len) {
+    auto &ctx = *static_cast<TrickleWriter *>(uctx.ctx);
+    size_t const n = std::min(*len, ctx.budget);
+    ctx.buf.insert(ctx.buf.end(), buf, buf + n);
+    ctx.budget -= n;
+
+    bool const all = n == *len;
+    *len = n;
+    return all ? dut::slipc_io_writer_result_t::SLIPC_IO_WRITER_OK
+               : dut::slipc_io_writer_result_t::SLIPC_IO_WRITER_AGAIN;
+  }
+};
+
 TEST_CASE("Encoding single bytes", "[encode]") {
   auto [byte, exp_encoded] = GENERATE(table<uint8_t, std::vector<uint8_t>>({
       {0, {0}},
@@ -417,6 +473,766 @@ TEST_CASE("Transfer encode", "[transfer]") {
   }
 }
 
+TEST_CASE("Resumable encode", "[encode]") {
+  std::vector<uint8_t> const payload = {
+      1,
+      dut::slipc_char_t::SLIPC_END,
+      dut::slipc_char_t::SLIPC_ESC,
+      2,
+      3,
+      dut::slipc_char_t::SLIPC_END,
+      dut::slipc_char_t::SLIPC_END,
+      4,
+  };
+  bool const startbyte = GENERATE(false, true);
+  size_t const budget = GENERATE(1, 2, 3);
+
+  std::vector<uint8_t> expected(
+      SLIPC_ENCODED_SIZE_MAX(payload.size(), startbyte));
+  dut::slipc_io_buffer_writer_t buffer;
+  auto buffer_writer = dut::slipc_io_writer_from_buffer(
+      &buffer, expected.data(), expected.size());
+  REQUIRE(dut::slipc_encode_packet(&buffer_writer, payload.data(),
+                                   payload.size(), startbyte) ==
+          dut::slipc_encoder_result_t::SLIPC_ENCODER_OK);
+  expected.resize(expected.size() - buffer.len);
+
+  TrickleWriter writer(budget);
+  auto encoder = dut::slipc_encoder_new(startbyte);
+  dut::slipc_encoder_result_t res;
+  size_t calls = 0;
+
+  SECTION("Packet") {
+    do {
+      writer.budget = budget;
+      res = dut::slipc_encoder_write(&encoder, &writer, payload.data(),
+                                     payload.size());
+      calls++;
+    } while (res == dut::slipc_encoder_result_t::SLIPC_ENCODER_AGAIN &&
+             calls < 100);
+
+    CHECK(res == dut::slipc_encoder_result_t::SLIPC_ENCODER_OK);
+    CHECK(calls > 1);
+    CHECK(writer.buf == expected);
+    CHECK(encoder.stats.frames == 1);
+    CHECK(encoder.stats.bytes_in == payload.size());
+    CHECK(encoder.stats.escapes == 4);
+
+    // The next frame starts from scratch.
+    writer.buf.clear();
+    writer.budget = SIZE_MAX;
+    CHECK(dut::slipc_encoder_write(&encoder, &writer, payload.data(),
+                                   payload.size()) ==
+          dut::slipc_encoder_result_t::SLIPC_ENCODER_OK);
+    CHECK(writer.buf == expected);
+  }
+
+  SECTION("Transfer") {
+    // Without a chunk buffer, with a short one and with a large one.
+    size_t const chunk_size = GENERATE(0u, 3u, 64u);
+    std::vector<uint8_t> chunk(chunk_size);
+    dut::slipc_encoder_set_chunk(&encoder, chunk_size ? chunk.data() : nullptr,
+                                 chunk_size);
+
+    VecReader reader(payload);
+    do {
+      writer.budget = budget;
+      res = dut::slipc_encoder_transfer(&encoder, &reader, &writer);
+      calls++;
+    } while (res == dut::slipc_encoder_result_t::SLIPC_ENCODER_AGAIN &&
+             calls < 100);
+
+    CHECK(res == dut::slipc_encoder_result_t::SLIPC_ENCODER_OK);
+    CHECK(calls > 1);
+    CHECK(writer.buf == expected);
+    CHECK(encoder.stats.frames == 1);
+    CHECK(encoder.stats.escapes == 4);
+  }
+}
+
+TEST_CASE("Bulk encode", "[encode]") {
+  SECTION("Clean runs are written in one call") {
+    std::vector<uint8_t> payload(200, 0x42);
+    payload[100] = dut::slipc_char_t::SLIPC_END;
+
+    std::vector<uint8_t> expected(payload.begin(), payload.begin() + 100);
+    expected.push_back(dut::slipc_char_t::SLIPC_ESC);
+    expected.push_back(dut::slipc_char_t::SLIPC_ESC_END);
+    expected.insert(expected.end(), payload.begin() + 101, payload.end());
+    expected.push_back(dut::slipc_char_t::SLIPC_END);
+
+    SECTION("Packet") {
+      VecWriter writer;
+      auto res = dut::slipc_encode_packet(&writer, payload.data(),
+                                          payload.size(), false);
+      CHECK(res == dut::slipc_encoder_result_t::SLIPC_ENCODER_OK);
+      CHECK(writer.buf == expected);
+      // Run, escape, run, END
+      CHECK(writer.calls == 4);
+    }
+
+    SECTION("Transfer") {
+      VecWriter writer;
+      VecReader reader(payload);
+      uint8_t chunk[64];
+      auto encoder = dut::slipc_encoder_new(false);
+      dut::slipc_encoder_set_chunk(&encoder, chunk, sizeof(chunk));
+      auto res = dut::slipc_encoder_transfer(&encoder, &reader, &writer);
+      CHECK(res == dut::slipc_encoder_result_t::SLIPC_ENCODER_OK);
+      CHECK(writer.buf == expected);
+      CHECK(writer.calls < payload.size() / 8);
+    }
+
+    SECTION("Transfer without a chunk buffer") {
+      VecWriter writer;
+      VecReader reader(payload);
+      auto encoder = dut::slipc_encoder_new(false);
+      auto res = dut::slipc_encoder_transfer(&encoder, &reader, &writer);
+      CHECK(res == dut::slipc_encoder_result_t::SLIPC_ENCODER_OK);
+      CHECK(writer.buf == expected);
+      CHECK(reader.calls >= payload.size());
+    }
+  }
+
+  SECTION("Empty packet") {
+    VecWriter writer;
+    uint8_t const payload = 0;
+    auto res = dut::slipc_encode_packet(&writer, &payload, 0, true);
+    CHECK(res == dut::slipc_encoder_result_t::SLIPC_ENCODER_OK);
+    CHECK(writer.buf == EMPTY_PACKET_WITH_START.encoded);
+  }
+}
+
+static std::vector<uint8_t> random_payload(std::mt19937 &rng, size_t len,
+                                           unsigned special_permille) {
+  std::uniform_int_distribution<unsigned> byte_dist(0, 255);
+  std::uniform_int_distribution<unsigned> permille_dist(0, 999);
+  std::vector<uint8_t> payload(len);
+  for (auto &byte : payload) {
+    if (permille_dist(rng) < special_permille) {
+      uint8_t const specials[] = {
+          dut::slipc_char_t::SLIPC_END,
+          dut::slipc_char_t::SLIPC_ESC,
+          dut::slipc_char_t::SLIPC_ESC_END,
+          dut::slipc_char_t::SLIPC_ESC_ESC,
+      };
+      byte = specials[byte_dist(rng) % 4];
+    } else {
+      byte = byte_dist(rng);
+    }
+  }
+  return payload;
+}
+
+struct ReferenceDecode {
+  dut::slipc_decoder_result_t result;
+  std::vector<uint8_t> decoded;
+  bool malformed;
+};
+
+/**
+ * \brief Decode one packet with slipc_decode_byte() only.
+ */
+static ReferenceDecode reference_decode(std::vector<uint8_t> const &encoded,
+                                        bool startbyte) {
+  auto decoder = dut::slipc_decoder_new(startbyte);
+  VecWriter writer;
+  auto it = encoded.begin();
+
+  auto result = [&](dut::slipc_decoder_result_t result) {
+    return ReferenceDecode{result, writer.buf, decoder.malformed};
+  };
+
+  if (startbyte) {
+    it = std::find(it, encoded.end(), dut::slipc_char_t::SLIPC_END);
+    if (it == encoded.end()) {
+      return result(dut::slipc_decoder_result_t::SLIPC_DECODER_NOT_FOUND);
+    }
+    it++;
+  }
+
+  if (it == encoded.end()) {
+    return result(dut::slipc_decoder_result_t::SLIPC_DECODER_NOT_FOUND);
+  }
+
+  for (; it != encoded.end(); it++) {
+    auto res = dut::slipc_decode_byte(&decoder, &writer, *it);
+    if (res == dut::slipc_decoder_result_t::SLIPC_DECODER_EOF) {
+      return result(res);
+    }
+  }
+  return result(dut::slipc_decoder_result_t::SLIPC_DECODER_MORE);
+}
+
+/**
+ * \brief Select a scan kernel for one test, back to the best one after it.
+ */
+struct KernelOverride {
+  bool const supported;
+
+  explicit KernelOverride(dut::slipc_kernel_t kernel)
+      : supported(dut::slipc_kernel_set(kernel)) {}
+  ~KernelOverride() { dut::slipc_kernel_set(dut::SLIPC_KERNEL_AUTO); }
+};
+
+TEST_CASE("Kernel dispatch", "[encode][decode]") {
+  auto const best = dut::slipc_kernel_get();
+  CHECK(best != dut::SLIPC_KERNEL_AUTO);
+  CHECK(dut::slipc_kernel_supported(best));
+  CHECK(dut::slipc_kernel_supported(dut::SLIPC_KERNEL_SCALAR));
+  CHECK_FALSE(dut::slipc_kernel_supported(dut::SLIPC_KERNEL_AUTO));
+  CHECK_FALSE(dut::slipc_kernel_supported(dut::SLIPC_KERNEL_COUNT));
+
+  SECTION("Override") {
+    KernelOverride kernel(dut::SLIPC_KERNEL_SCALAR);
+    CHECK(kernel.supported);
+    CHECK(dut::slipc_kernel_get() == dut::SLIPC_KERNEL_SCALAR);
+  }
+
+  SECTION("Unsupported kernel") {
+    KernelOverride kernel(dut::SLIPC_KERNEL_COUNT);
+    CHECK_FALSE(kernel.supported);
+    CHECK(dut::slipc_kernel_get() == best);
+  }
+
+  SECTION("Names") {
+    CHECK(std::string(dut::slipc_kernel_name(dut::SLIPC_KERNEL_SCALAR)) ==
+          "scalar");
+    CHECK(std::string(dut::slipc_kernel_name(dut::SLIPC_KERNEL_AVX2)) ==
+          "avx2");
+    CHECK(std::string(dut::slipc_kernel_name(dut::SLIPC_KERNEL_COUNT)) ==
+          "unknown");
+  }
+
+  CHECK(dut::slipc_kernel_get() == best);
+}
+
+TEST_CASE("Buffer paths match the byte reference", "[encode][decode]") {
+  auto kernel_id = GENERATE(
+      dut::SLIPC_KERNEL_SCALAR, dut::SLIPC_KERNEL_SSE2, dut::SLIPC_KERNEL_AVX2,
+      dut::SLIPC_KERNEL_AVX512, dut::SLIPC_KERNEL_NEON);
+  KernelOverride kernel(kernel_id);
+  if (!kernel.supported) {
+    return;
+  }
+
+  auto special_permille = GENERATE(0u, 10u, 500u, 1000u);
+  auto startbyte = GENERATE(false, true);
+  std::mt19937 rng(special_permille + startbyte);
+
+  SECTION("Encode") {
+    for (size_t len = 1; len < 300; len += 7) {
+      auto payload = random_payload(rng, len, special_permille);
+      INFO("Length " << len << " specials " << special_permille);
+
+      VecWriter reference;
+      if (startbyte) {
+        reference.buf.push_back(dut::slipc_char_t::SLIPC_END);
+      }
+      for (auto byte : payload) {
+        dut::slipc_encode_byte(&reference, byte);
+      }
+      reference.buf.push_back(dut::slipc_char_t::SLIPC_END);
+
+      VecWriter writer;
+      auto res = dut::slipc_encode_packet(&writer, payload.data(),
+                                          payload.size(), startbyte);
+      CHECK(res == dut::slipc_encoder_result_t::SLIPC_ENCODER_OK);
+      CHECK(writer.buf == reference.buf);
+      CHECK(dut::slipc_encoded_size(payload.data(), payload.size(),
+                                    startbyte) == reference.buf.size());
+    }
+  }
+
+  SECTION("Decode") {
+    for (size_t len = 1; len < 300; len += 7) {
+      auto payload = random_payload(rng, len, special_permille);
+      INFO("Length " << len << " specials " << special_permille);
+
+      auto const reference = reference_decode(payload, startbyte);
+
+      VecWriter writer;
+      auto decoder = dut::slipc_decoder_new(startbyte);
+      auto res = dut::slipc_decoder_decode_packet(
+          &decoder, &writer, payload.data(), payload.size());
+
+      CHECK(res == reference.result);
+      CHECK(writer.buf == reference.decoded);
+      CHECK(dut::slipc_decoder_is_malformed(&decoder) == reference.malformed);
+
+      VecWriter transfer_writer;
+      VecReader reader(payload);
+      auto transfer_decoder = dut::slipc_decoder_new(startbyte);
+      res = dut::slipc_decoder_transfer(&transfer_decoder, &reader,
+                                        &transfer_writer);
+
+      CHECK(res == reference.result);
+      CHECK(transfer_writer.buf == reference.decoded);
+      CHECK(dut::slipc_decoder_is_malformed(&transfer_decoder) ==
+            reference.malformed);
+
+      auto in_place = payload;
+      size_t in_len = in_place.size();
+      size_t out_len;
+      auto in_place_decoder = dut::slipc_decoder_new(startbyte);
+      res = dut::slipc_decoder_decode_packet_in_place(
+          &in_place_decoder, in_place.data(), &in_len, &out_len);
+
+      CHECK(res == reference.result);
+      CHECK(std::vector<uint8_t>(in_place.begin(),
+                                 in_place.begin() + out_len) ==
+            reference.decoded);
+      CHECK(dut::slipc_decoder_is_malformed(&in_place_decoder) ==
+            reference.malformed);
+    }
+  }
+}
+
+/**
+ * \brief Feed chunks of at most chunk_len bytes and collect all frames.
+ */
+static std::vector<std::vector<uint8_t>>
+feed_frames(dut::slipc_decoder_t &decoder, std::vector<uint8_t> const &input,
+            size_t chunk_len, size_t out_chunk_len) {
+  std::vector<std::vector<uint8_t>> frames;
+  std::vector<uint8_t> frame;
+  size_t pos = 0;
+
+  while (pos < input.size()) {
+    size_t in_len = std::min(chunk_len, input.size() - pos);
+    uint8_t out[64];
+    size_t out_len = std::min(out_chunk_len, sizeof(out));
+
+    auto res = dut::slipc_decoder_feed(&decoder, input.data() + pos, &in_len,
+                                       out, &out_len);
+    REQUIRE(res != dut::slipc_decoder_result_t::SLIPC_DECODER_IO_ERROR);
+
+    pos += in_len;
+    frame.insert(frame.end(), out, out + out_len);
+    if (res == dut::slipc_decoder_result_t::SLIPC_DECODER_EOF) {
+      frames.push_back(frame);
+      frame.clear();
+    }
+  }
+  return frames;
+}
+
+TEST_CASE("Feed decode", "[decode]") {
+  SECTION("Several frames in one buffer") {
+    std::vector<uint8_t> input = GOOD_PACKET.encoded;
+    input.insert(input.end(), MALFORMED_PACKET.encoded.begin(),
+                 MALFORMED_PACKET.encoded.end());
+    input.insert(input.end(), EMPTY_PACKET.encoded.begin(),
+                 EMPTY_PACKET.encoded.end());
+    input.insert(input.end(), GOOD_PACKET.encoded.begin(),
+                 GOOD_PACKET.encoded.end());
+
+    auto decoder = dut::slipc_decoder_new(false);
+    size_t pos = 0;
+    std::vector<uint8_t> out(64);
+
+    auto feed = [&]() {
+      size_t in_len = input.size() - pos;
+      size_t out_len = out.size();
+      auto res = dut::slipc_decoder_feed(&decoder, input.data() + pos, &in_len,
+                                         out.data(), &out_len);
+      pos += in_len;
+      out.resize(out_len);
+      return res;
+    };
+
+    CHECK(feed() == dut::slipc_decoder_result_t::SLIPC_DECODER_EOF);
+    CHECK(out == GOOD_PACKET.decoded);
+    CHECK(!dut::slipc_decoder_is_malformed(&decoder));
+    CHECK(pos == GOOD_PACKET.encoded.size());
+
+    out.resize(64);
+    CHECK(feed() == dut::slipc_decoder_result_t::SLIPC_DECODER_EOF);
+    CHECK(out == MALFORMED_PACKET.decoded);
+    CHECK(dut::slipc_decoder_is_malformed(&decoder));
+
+    out.resize(64);
+    CHECK(feed() == dut::slipc_decoder_result_t::SLIPC_DECODER_EOF);
+    CHECK(out.empty());
+    CHECK(!dut::slipc_decoder_is_malformed(&decoder));
+
+    out.resize(64);
+    CHECK(feed() == dut::slipc_decoder_result_t::SLIPC_DECODER_EOF);
+    CHECK(out == GOOD_PACKET.decoded);
+    CHECK(pos == input.size());
+
+    out.resize(64);
+    CHECK(feed() == dut::slipc_decoder_result_t::SLIPC_DECODER_MORE);
+    CHECK(out.empty());
+  }
+
+  SECTION("Chunk and output sizes do not matter") {
+    std::vector<uint8_t> input = NOISY_PACKET.encoded;
+    input.insert(input.end(), MALFORMED_NOISY_PACKET.encoded.begin(),
+                 MALFORMED_NOISY_PACKET.encoded.end());
+    input.push_back(dut::slipc_char_t::SLIPC_END);
+
+    auto chunk_len = GENERATE(1u, 2u, 3u, 7u, 64u);
+    auto out_chunk_len = GENERATE(1u, 5u, 64u);
+    INFO("Chunk " << chunk_len << " output " << out_chunk_len);
+
+    auto decoder = dut::slipc_decoder_new(true);
+    auto frames = feed_frames(decoder, input, chunk_len, out_chunk_len);
+
+    REQUIRE(frames.size() == 2);
+    CHECK(frames[0] == NOISY_PACKET.decoded);
+    CHECK(frames[1] == MALFORMED_PACKET.decoded);
+  }
+
+  SECTION("Noise only") {
+    auto const input = std::vector<uint8_t>{1, 2, dut::slipc_char_t::SLIPC_ESC};
+    auto decoder = dut::slipc_decoder_new(true);
+
+    size_t in_len = input.size();
+    uint8_t out[8];
+    size_t out_len = sizeof(out);
+    auto res =
+        dut::slipc_decoder_feed(&decoder, input.data(), &in_len, out, &out_len);
+
+    CHECK(res == dut::slipc_decoder_result_t::SLIPC_DECODER_NOT_FOUND);
+    CHECK(in_len == input.size());
+    CHECK(out_len == 0);
+  }
+}
+
+TEST_CASE("Frames decode", "[decode]") {
+  std::vector<uint8_t> input = GOOD_PACKET_WITH_START.encoded;
+  input.insert(input.end(), MALFORMED_PACKET_WITH_START.encoded.begin(),
+               MALFORMED_PACKET_WITH_START.encoded.end());
+  input.insert(input.end(), EMPTY_PACKET_WITH_START.encoded.begin(),
+               EMPTY_PACKET_WITH_START.encoded.end());
+  size_t const complete = input.size();
+  // Incomplete frame
+  input.insert(input.end(), {dut::slipc_char_t::SLIPC_END, 1, 2});
+
+  std::vector<uint8_t> out(128);
+  dut::slipc_frame_desc_t frames[8];
+
+  SECTION("All frames") {
+    auto decoder = dut::slipc_decoder_new(true);
+    size_t len = input.size();
+    size_t count = std::size(frames);
+    auto res = dut::slipc_decoder_decode_frames(
+        &decoder, input.data(), &len, out.data(), out.size(), frames, &count);
+
+    CHECK(res == dut::slipc_decoder_result_t::SLIPC_DECODER_MORE);
+    CHECK(len == complete);
+    REQUIRE(count == 3);
+
+    auto frame = [&](size_t i) {
+      return std::vector<uint8_t>(out.begin() + frames[i].offset,
+                                  out.begin() + frames[i].offset +
+                                      frames[i].len);
+    };
+    CHECK(frame(0) == GOOD_PACKET.decoded);
+    CHECK(!frames[0].malformed);
+    CHECK(frame(1) == MALFORMED_PACKET.decoded);
+    CHECK(frames[1].malformed);
+    CHECK(frames[2].len == 0);
+    CHECK(!frames[2].malformed);
+
+    // The incomplete frame completes with the next chunk.
+    std::vector<uint8_t> rest(input.begin() + len, input.end());
+    rest.push_back(dut::slipc_char_t::SLIPC_END);
+    len = rest.size();
+    count = std::size(frames);
+    res = dut::slipc_decoder_decode_frames(
+        &decoder, rest.data(), &len, out.data(), out.size(), frames, &count);
+
+    CHECK(res == dut::slipc_decoder_result_t::SLIPC_DECODER_MORE);
+    CHECK(len == rest.size());
+    REQUIRE(count == 1);
+    CHECK(frame(0) == std::vector<uint8_t>{1, 2});
+  }
+
+  SECTION("Frames full") {
+    auto decoder = dut::slipc_decoder_new(true);
+    size_t len = input.size();
+    size_t count = 1;
+    auto res = dut::slipc_decoder_decode_frames(
+        &decoder, input.data(), &len, out.data(), out.size(), frames, &count);
+
+    CHECK(res == dut::slipc_decoder_result_t::SLIPC_DECODER_EOF);
+    CHECK(len == GOOD_PACKET_WITH_START.encoded.size());
+    CHECK(count == 1);
+  }
+
+  SECTION("Output full") {
+    auto decoder = dut::slipc_decoder_new(true);
+    size_t len = input.size();
+    size_t count = std::size(frames);
+    auto res = dut::slipc_decoder_decode_frames(&decoder, input.data(), &len,
+                                                out.data(), 12, frames, &count);
+
+    CHECK(res == dut::slipc_decoder_result_t::SLIPC_DECODER_EOF);
+    CHECK(len == GOOD_PACKET_WITH_START.encoded.size());
+    CHECK(count == 1);
+  }
+
+  SECTION("Frame larger than the output") {
+    // Calling again on EOF gets through frames that can never fit.
+    auto decoder = dut::slipc_decoder_new(true);
+    std::vector<dut::slipc_frame_desc_t> seen;
+    size_t pos = 0;
+    size_t calls = 0;
+    dut::slipc_decoder_result_t res;
+    do {
+      size_t len = input.size() - pos;
+      size_t count = std::size(frames);
+      res = dut::slipc_decoder_decode_frames(&decoder, input.data() + pos,
+                                             &len, out.data(), 3, frames,
+                                             &count);
+      if (calls == 0) {
+        REQUIRE(count == 1);
+        CHECK(std::equal(out.begin(), out.begin() + 3,
+                         GOOD_PACKET.decoded.begin()));
+      }
+      pos += len;
+      seen.insert(seen.end(), frames, frames + count);
+      calls++;
+    } while (res == dut::slipc_decoder_result_t::SLIPC_DECODER_EOF &&
+             calls < 10);
+
+    CHECK(res == dut::slipc_decoder_result_t::SLIPC_DECODER_MORE);
+    CHECK(pos == complete);
+    REQUIRE(seen.size() == 3);
+    CHECK(seen[0].oversize);
+    CHECK(seen[0].len == 3);
+    CHECK(seen[1].oversize);
+    CHECK(!seen[2].oversize);
+    CHECK(seen[2].len == 0);
+    CHECK(decoder.stats.oversize == 2);
+  }
+
+  SECTION("In place") {
+    input = GOOD_PACKET.encoded;
+    input.insert(input.end(), GOOD_PACKET.encoded.begin(),
+                 GOOD_PACKET.encoded.end());
+
+    auto decoder = dut::slipc_decoder_new(false);
+    size_t len = input.size();
+    size_t count = std::size(frames);
+    dut::slipc_decoder_decode_frames(&decoder, input.data(), &len,
+                                     input.data(), input.size(), frames,
+                                     &count);
+
+    REQUIRE(count == 2);
+    CHECK(frames[1].offset == GOOD_PACKET.decoded.size());
+    CHECK(std::vector<uint8_t>(input.begin() + frames[1].offset,
+                               input.begin() + frames[1].offset +
+                                   frames[1].len) == GOOD_PACKET.decoded);
+  }
+}
+
+TEST_CASE("In place decode", "[decode]") {
+  auto [packet, startbyte] = GENERATE(table<InputDecode, bool>({
+      {GOOD_PACKET, false},
+      {GOOD_PACKET_WITH_START, true},
+      {NOISY_PACKET, true},
+      {MALFORMED_PACKET, false},
+      {MALFORMED_NOISY_PACKET, true},
+      {EMPTY_PACKET_WITH_NOISE, true},
+  }));
+
+  auto buf = packet.encoded;
+  auto decoder = dut::slipc_decoder_new(startbyte);
+  size_t len = buf.size();
+  size_t out_len;
+  auto res = dut::slipc_decoder_decode_packet_in_place(&decoder, buf.data(),
+                                                       &len, &out_len);
+
+  CHECK(res == dut::slipc_decoder_result_t::SLIPC_DECODER_EOF);
+  CHECK(std::vector<uint8_t>(buf.begin(), buf.begin() + out_len) ==
+        packet.decoded);
+  CHECK(packet.encoded[len - 1] == dut::slipc_char_t::SLIPC_END);
+}
+
+TEST_CASE("Fixed startbyte variants", "[encode][decode]") {
+  using R = dut::slipc_decoder_result_t;
+
+  SECTION("Encode") {
+    VecWriter sb, nosb;
+    CHECK(dut::slipc_encode_packet_sb(&sb, GOOD_PACKET.decoded.data(),
+                                      GOOD_PACKET.decoded.size()) ==
+          dut::slipc_encoder_result_t::SLIPC_ENCODER_OK);
+    CHECK(dut::slipc_encode_packet_nosb(&nosb, GOOD_PACKET.decoded.data(),
+                                        GOOD_PACKET.decoded.size()) ==
+          dut::slipc_encoder_result_t::SLIPC_ENCODER_OK);
+    CHECK(sb.buf == GOOD_PACKET_WITH_START.encoded);
+    CHECK(nosb.buf == GOOD_PACKET.encoded);
+  }
+
+  SECTION("Decode packet") {
+    auto decoder = dut::slipc_decoder_new(false);
+    VecWriter sb, nosb;
+    CHECK(dut::slipc_decoder_decode_packet_sb(
+              &decoder, &sb, NOISY_PACKET.encoded.data(),
+              NOISY_PACKET.encoded.size()) == R::SLIPC_DECODER_EOF);
+    CHECK(dut::slipc_decoder_decode_packet_nosb(
+              &decoder, &nosb, GOOD_PACKET.encoded.data(),
+              GOOD_PACKET.encoded.size()) == R::SLIPC_DECODER_EOF);
+    CHECK(sb.buf == NOISY_PACKET.decoded);
+    CHECK(nosb.buf == GOOD_PACKET.decoded);
+  }
+
+  SECTION("Transfer and feed") {
+    auto decoder = dut::slipc_decoder_new(false);
+    VecReader reader(NOISY_PACKET.encoded);
+    VecWriter writer;
+    CHECK(dut::slipc_decoder_transfer_sb(&decoder, &reader, &writer) ==
+          R::SLIPC_DECODER_EOF);
+    CHECK(writer.buf == NOISY_PACKET.decoded);
+
+    std::vector<uint8_t> out(GOOD_PACKET.decoded.size());
+    size_t in_len = GOOD_PACKET.encoded.size();
+    size_t out_len = out.size();
+    CHECK(dut::slipc_decoder_feed_nosb(&decoder, GOOD_PACKET.encoded.data(),
+                                       &in_len, out.data(), &out_len) ==
+          R::SLIPC_DECODER_EOF);
+    CHECK(out == GOOD_PACKET.decoded);
+  }
+}
+
+TEST_CASE("Vectored encode", "[encode]") {
+  auto startbyte = GENERATE(false, true);
+  std::mt19937 rng(startbyte);
+
+  for (size_t len = 1; len < 400; len += 13) {
+    auto payload = random_payload(rng, len, 100);
+    INFO("Length " << len);
+
+    VecWriter reference;
+    dut::slipc_encode_packet(&reference, payload.data(), payload.size(),
+                             startbyte);
+
+    VecVecWriter writer;
+    auto res = dut::slipc_encode_packet_vec(&writer, payload.data(),
+                                            payload.size(), startbyte);
+    CHECK(res == dut::slipc_encoder_result_t::SLIPC_ENCODER_OK);
+    CHECK(writer.buf == reference.buf);
+
+    // Runs point into the payload instead of copies.
+    size_t referenced = 0;
+    for (auto const &vec : writer.vecs) {
+      if (vec.data >= payload.data() &&
+          vec.data < payload.data() + payload.size()) {
+        referenced += vec.len;
+      }
+    }
+    size_t const escapes =
+        dut::slipc_encoded_size(payload.data(), payload.size(), false) -
+        payload.size() - 1;
+    CHECK(referenced == payload.size() - escapes);
+  }
+}
+
+TEST_CASE("Encoded size", "[encode]") {
+  static_assert(SLIPC_ENCODED_SIZE_MAX(0, false) == 1);
+  static_assert(SLIPC_ENCODED_SIZE_MAX(10, true) == 22);
+
+  auto const packet = GOOD_PACKET_WITH_START;
+  size_t const size = dut::slipc_encoded_size(packet.decoded.data(),
+                                              packet.decoded.size(), true);
+  CHECK(size == packet.encoded.size());
+  CHECK(size <= SLIPC_ENCODED_SIZE_MAX(packet.decoded.size(), true));
+
+  SECTION("Exactly sized buffer") {
+    std::vector<uint8_t> out(size);
+    dut::slipc_io_buffer_writer_t writer_ctx;
+    auto writer =
+        dut::slipc_io_writer_from_buffer(&writer_ctx, out.data(), out.size());
+    auto res = dut::slipc_encode_packet(&writer, packet.decoded.data(),
+                                        packet.decoded.size(), true);
+    CHECK(res == dut::slipc_encoder_result_t::SLIPC_ENCODER_OK);
+    CHECK(out == packet.encoded);
+  }
+
+  SECTION("Too small buffer") {
+    std::vector<uint8_t> out(size - 1);
+    dut::slipc_io_buffer_writer_t writer_ctx;
+    auto writer =
+        dut::slipc_io_writer_from_buffer(&writer_ctx, out.data(), out.size());
+    auto res = dut::slipc_encode_packet(&writer, packet.decoded.data(),
+                                        packet.decoded.size(), true);
+    CHECK(res == dut::slipc_encoder_result_t::SLIPC_ENCODER_IO_ERROR);
+  }
+}
+
+TEST_CASE("Batch encode", "[encode]") {
+  std::vector<uint8_t> const end = {dut::slipc_char_t::SLIPC_END};
+  std::vector<dut::slipc_io_vec_t> const frames = {
+      {GOOD_PACKET.decoded.data(), GOOD_PACKET.decoded.size()},
+      {end.data(), 0},
+      {end.data(), end.size()},
+  };
+  bool const startbyte = GENERATE(false, true);
+
+  // Same as encoding each packet.
+  std::vector<uint8_t> expected;
+  std::vector<size_t> offsets;
+  for (auto const &frame : frames) {
+    std::vector<uint8_t> out(SLIPC_ENCODED_SIZE_MAX(frame.len, startbyte));
+    dut::slipc_io_buffer_writer_t writer_ctx;
+    auto writer =
+        dut::slipc_io_writer_from_buffer(&writer_ctx, out.data(), out.size());
+    REQUIRE(dut::slipc_encode_packet(&writer, frame.data, frame.len,
+                                     startbyte) ==
+            dut::slipc_encoder_result_t::SLIPC_ENCODER_OK);
+    expected.insert(expected.end(), out.begin(), out.end() - writer_ctx.len);
+    offsets.push_back(expected.size());
+  }
+
+  SECTION("All frames fit") {
+    std::vector<uint8_t> out(expected.size());
+    std::vector<size_t> got(frames.size());
+    size_t len = out.size();
+    size_t count = frames.size();
+    CHECK(dut::slipc_encode_frames(out.data(), &len, frames.data(), &count,
+                                   got.data(), startbyte) ==
+          dut::slipc_encoder_result_t::SLIPC_ENCODER_OK);
+    CHECK(len == expected.size());
+    CHECK(count == frames.size());
+    CHECK(out == expected);
+    CHECK(got == offsets);
+  }
+
+  SECTION("Decoders find every frame") {
+    std::vector<std::vector<uint8_t>> const payloads = {
+        {1, 2}, {3, 4}, {5, 6}};
+    std::vector<dut::slipc_io_vec_t> vecs;
+    for (auto const &payload : payloads) {
+      vecs.push_back({payload.data(), payload.size()});
+    }
+    std::vector<uint8_t> out(64);
+    size_t len = out.size();
+    size_t count = vecs.size();
+    REQUIRE(dut::slipc_encode_frames(out.data(), &len, vecs.data(), &count,
+                                     nullptr, startbyte) ==
+            dut::slipc_encoder_result_t::SLIPC_ENCODER_OK);
+    out.resize(len);
+
+    auto decoder = dut::slipc_decoder_new(startbyte);
+    CHECK(feed_frames(decoder, out, out.size(), 64) == payloads);
+  }
+
+  SECTION("Output full") {
+    std::vector<uint8_t> out(expected.size() - 1);
+    size_t len = out.size();
+    size_t count = frames.size();
+    CHECK(dut::slipc_encode_frames(out.data(), &len, frames.data(), &count,
+                                   nullptr, startbyte) ==
+          dut::slipc_encoder_result_t::SLIPC_ENCODER_AGAIN);
+    CHECK(count == 2);
+    CHECK(len == offsets[1]);
+    CHECK(std::equal(out.begin(), out.begin() + len, expected.begin()));
+  }
+}
+
 TEST_CASE("Transfer decode", "[decode]") {
   VecWriter writer(dut::slipc_io_writer_result_t::SLIPC_IO_WRITER_OK);
 
@@ -559,6 +1375,1262 @@ TEST_CASE("Transfer decode", "[decode]") {
   }
 }
 
+TEST_CASE("Transfer decode stream", "[decode]") {
+  std::vector<uint8_t> input = NOISY_PACKET.encoded;
+  input.insert(input.end(), GOOD_PACKET_WITH_START.encoded.begin(),
+               GOOD_PACKET_WITH_START.encoded.end());
+  input.insert(input.end(), MALFORMED_PACKET_WITH_START.encoded.begin(),
+               MALFORMED_PACKET_WITH_START.encoded.end());
+  input.insert(input.end(), {dut::slipc_char_t::SLIPC_END, 1, 2});
+
+  struct CountingReader : VecReader {
+    size_t calls = 0;
+
+    CountingReader(std::vector<uint8_t> buf) : VecReader(buf) {
+      user_ctx = {this};
+      read = counting_cb;
+    }
+
+    static dut::slipc_io_reader_result_t
+    counting_cb(dut::slipc_io_user_ctx_t uctx, uint8_t *buf, size_t *len) {
+      static_cast<CountingReader *>(uctx.ctx)->calls++;
+      return reader_cb(uctx, buf, len);
+    }
+  };
+
+  CountingReader reader(input);
+  auto decoder = dut::slipc_decoder_new(true);
+
+  auto transfer = [&](dut::slipc_decoder_result_t exp_res,
+                      std::vector<uint8_t> const &exp_decoded) {
+    VecWriter writer;
+    auto res = dut::slipc_decoder_transfer(&decoder, &reader, &writer);
+    CHECK(res == exp_res);
+    CHECK(writer.buf == exp_decoded);
+  };
+
+  transfer(dut::slipc_decoder_result_t::SLIPC_DECODER_EOF,
+           NOISY_PACKET.decoded);
+  transfer(dut::slipc_decoder_result_t::SLIPC_DECODER_EOF,
+           GOOD_PACKET.decoded);
+  CHECK(!dut::slipc_decoder_is_malformed(&decoder));
+  transfer(dut::slipc_decoder_result_t::SLIPC_DECODER_EOF,
+           MALFORMED_PACKET.decoded);
+  CHECK(dut::slipc_decoder_is_malformed(&decoder));
+  transfer(dut::slipc_decoder_result_t::SLIPC_DECODER_MORE, {1, 2});
+  transfer(dut::slipc_decoder_result_t::SLIPC_DECODER_NOT_FOUND, {});
+
+  // Whole chunks, plus at most one short read for each of the 5 transfers.
+  CHECK(reader.calls <= input.size() / SLIPC_TRANSFER_CHUNK_SIZE + 5);
+}
+
+TEST_CASE("Maximum frame length", "[decode]") {
+  std::mt19937 rng(14);
+  auto payload = random_payload(rng, 1000, 100);
+
+  VecWriter encoded;
+  REQUIRE(dut::slipc_encode_packet(&encoded, payload.data(), payload.size(),
+                                   false) ==
+          dut::slipc_encoder_result_t::SLIPC_ENCODER_OK);
+  std::vector<uint8_t> input = encoded.buf;
+  input.insert(input.end(), GOOD_PACKET.encoded.begin(),
+               GOOD_PACKET.encoded.end());
+
+  std::vector<uint8_t> const prefix(payload.begin(), payload.begin() + 16);
+  auto decoder = dut::slipc_decoder_new(false);
+  dut::slipc_decoder_set_max_len(&decoder, 16);
+
+  SECTION("Transfer stops writing and resyncs") {
+    VecReader reader(input);
+
+    VecWriter writer;
+    CHECK(dut::slipc_decoder_transfer(&decoder, &reader, &writer) ==
+          dut::slipc_decoder_result_t::SLIPC_DECODER_EOF);
+    CHECK(dut::slipc_decoder_is_oversize(&decoder));
+    CHECK(writer.buf == prefix);
+
+    VecWriter next;
+    CHECK(dut::slipc_decoder_transfer(&decoder, &reader, &next) ==
+          dut::slipc_decoder_result_t::SLIPC_DECODER_EOF);
+    CHECK(!dut::slipc_decoder_is_oversize(&decoder));
+    CHECK(next.buf == GOOD_PACKET.decoded);
+  }
+
+  SECTION("Feed consumes the oversize frame") {
+    auto chunk_len = GENERATE(1u, 7u, 4096u);
+    std::vector<uint8_t> out(64);
+    std::vector<std::vector<uint8_t>> frames;
+    std::vector<bool> oversize;
+    std::vector<uint8_t> frame;
+
+    for (size_t pos = 0; pos < input.size();) {
+      size_t in_len = std::min<size_t>(chunk_len, input.size() - pos);
+      size_t out_len = out.size();
+      auto res = dut::slipc_decoder_feed(&decoder, input.data() + pos, &in_len,
+                                         out.data(), &out_len);
+      REQUIRE(in_len > 0);
+      pos += in_len;
+      frame.insert(frame.end(), out.begin(), out.begin() + out_len);
+      if (res == dut::slipc_decoder_result_t::SLIPC_DECODER_EOF) {
+        frames.push_back(frame);
+        oversize.push_back(dut::slipc_decoder_is_oversize(&decoder));
+        frame.clear();
+      }
+    }
+
+    REQUIRE(frames.size() == 2);
+    CHECK(frames[0] == prefix);
+    CHECK(frames[1] == GOOD_PACKET.decoded);
+    CHECK(oversize == std::vector<bool>{true, false});
+  }
+
+  SECTION("Frames at the limit are kept") {
+    dut::slipc_decoder_set_max_len(&decoder, GOOD_PACKET.decoded.size());
+
+    VecWriter writer;
+    CHECK(dut::slipc_decoder_decode_packet(&decoder, &writer,
+                                           GOOD_PACKET.encoded.data(),
+                                           GOOD_PACKET.encoded.size()) ==
+          dut::slipc_decoder_result_t::SLIPC_DECODER_EOF);
+    CHECK(!dut::slipc_decoder_is_oversize(&decoder));
+    CHECK(writer.buf == GOOD_PACKET.decoded);
+  }
+}
+
+TEST_CASE("Statistics", "[decode][encode]") {
+  using C = dut::slipc_char_t;
+
+  SECTION("Decoder counts frames and invalid escapes") {
+    VecReader reader({C::SLIPC_END, 1, C::SLIPC_ESC, 7, 2, C::SLIPC_END,
+                      C::SLIPC_ESC, C::SLIPC_ESC_END, C::SLIPC_END});
+    auto decoder = dut::slipc_decoder_new(false);
+
+    for (int i = 0; i < 3; i++) {
+      VecWriter writer;
+      CHECK(dut::slipc_decoder_transfer(&decoder, &reader, &writer) ==
+            dut::slipc_decoder_result_t::SLIPC_DECODER_EOF);
+    }
+
+    CHECK(decoder.stats.frames == 3);
+    CHECK(decoder.stats.empty == 1);
+    CHECK(decoder.stats.bytes_in == 9);
+    CHECK(decoder.stats.bytes_out == 4);
+    CHECK(decoder.stats.invalid_escapes == 1);
+    CHECK(decoder.stats.skipped == 0);
+    CHECK(decoder.stats.oversize == 0);
+  }
+
+  SECTION("Decoder counts skipped and oversize bytes") {
+    std::vector<uint8_t> const input{9, 9, 9, C::SLIPC_END, 1, 2, 3, 4,
+                                     C::SLIPC_END};
+    auto decoder = dut::slipc_decoder_new(true);
+    dut::slipc_decoder_set_max_len(&decoder, 2);
+
+    std::vector<uint8_t> out(8);
+    size_t in_len = input.size();
+    size_t out_len = out.size();
+    CHECK(dut::slipc_decoder_feed(&decoder, input.data(), &in_len, out.data(),
+                                  &out_len) ==
+          dut::slipc_decoder_result_t::SLIPC_DECODER_EOF);
+
+    CHECK(decoder.stats.frames == 1);
+    CHECK(decoder.stats.skipped == 3);
+    CHECK(decoder.stats.oversize == 1);
+    CHECK(decoder.stats.bytes_in == input.size());
+    CHECK(decoder.stats.bytes_out == 2);
+    CHECK(decoder.stats.empty == 0);
+  }
+
+  SECTION("Encoder counts escapes") {
+    VecReader reader({C::SLIPC_END, 1, C::SLIPC_ESC});
+    VecWriter writer;
+    auto encoder = dut::slipc_encoder_new(false);
+
+    CHECK(dut::slipc_encoder_transfer(&encoder, &reader, &writer) ==
+          dut::slipc_encoder_result_t::SLIPC_ENCODER_OK);
+    CHECK(encoder.stats.frames == 1);
+    CHECK(encoder.stats.bytes_in == 3);
+    CHECK(encoder.stats.escapes == 2);
+  }
+}
+
+TEST_CASE("Tracing", "[decode][encode]") {
+  SECTION("Histogram buckets and percentiles") {
+    dut::slipc_trace_histogram_t hist = {};
+    CHECK(dut::slipc_trace_percentile(&hist, 500) == 0);
+
+    for (uint64_t value = 1; value <= 100; value++) {
+      dut::slipc_trace_record(&hist, value);
+    }
+    dut::slipc_trace_record(&hist, 0);
+    dut::slipc_trace_record(&hist, UINT64_MAX);
+
+    CHECK(dut::slipc_trace_count(&hist) == 102);
+    CHECK(hist.count[0] == 1);
+    CHECK(hist.count[1] == 1);
+    CHECK(hist.count[7] == 37);
+    CHECK(hist.count[SLIPC_TRACE_BUCKETS - 1] == 1);
+    CHECK(hist.max == UINT64_MAX);
+    CHECK(dut::slipc_trace_percentile(&hist, 500) == 63);
+    CHECK(dut::slipc_trace_percentile(&hist, 900) == 127);
+    CHECK(dut::slipc_trace_percentile(&hist, 1000) == UINT64_MAX);
+  }
+
+  SECTION("Clock never runs backwards") {
+    uint64_t prev = dut::slipc_trace_now();
+    CHECK(prev > 0);
+    bool monotonic = true;
+    for (int i = 0; i < 1000; i++) {
+      uint64_t const now = dut::slipc_trace_now();
+      monotonic = monotonic && now >= prev;
+      prev = now;
+    }
+    CHECK(monotonic);
+  }
+
+  SECTION("Traces merge") {
+    dut::slipc_trace_t a = {}, b = {};
+    dut::slipc_trace_record(&a.frame_ns, 10);
+    dut::slipc_trace_record(&b.frame_ns, 1000);
+    dut::slipc_trace_record(&b.io_ns, 3);
+    a.reader_calls = 2;
+    b.writer_calls = 5;
+
+    dut::slipc_trace_merge(&a, &b);
+    CHECK(dut::slipc_trace_count(&a.frame_ns) == 2);
+    CHECK(a.frame_ns.sum == 1010);
+    CHECK(a.frame_ns.max == 1000);
+    CHECK(dut::slipc_trace_count(&a.io_ns) == 1);
+    CHECK(a.reader_calls == 2);
+    CHECK(a.writer_calls == 5);
+  }
+
+#if SLIPC_ENABLE_TRACE
+  SECTION("Transfers record frames and callbacks") {
+    VecReader reader(GOOD_PACKET.encoded);
+    VecWriter writer;
+    auto decoder = dut::slipc_decoder_new(false);
+    CHECK(dut::slipc_decoder_transfer(&decoder, &reader, &writer) ==
+          dut::slipc_decoder_result_t::SLIPC_DECODER_EOF);
+
+    auto const &trace = decoder.stats.trace;
+    CHECK(dut::slipc_trace_count(&trace.frame_ns) == 1);
+    CHECK(trace.frame_bytes.sum == GOOD_PACKET.encoded.size());
+    CHECK(trace.reader_calls == 1);
+    CHECK(trace.writer_calls == writer.calls);
+    CHECK(dut::slipc_trace_count(&trace.io_ns) == 1 + writer.calls);
+
+    VecReader payload(GOOD_PACKET.decoded);
+    TrickleWriter trickle(4);
+    auto encoder = dut::slipc_encoder_new(false);
+    CHECK(dut::slipc_encoder_transfer(&encoder, &payload, &trickle) ==
+          dut::slipc_encoder_result_t::SLIPC_ENCODER_AGAIN);
+    CHECK(dut::slipc_trace_count(&encoder.stats.trace.frame_ns) == 0);
+
+    trickle.budget = SIZE_MAX;
+    CHECK(dut::slipc_encoder_transfer(&encoder, &payload, &trickle) ==
+          dut::slipc_encoder_result_t::SLIPC_ENCODER_OK);
+    CHECK(trickle.buf == GOOD_PACKET.encoded);
+    CHECK(dut::slipc_trace_count(&encoder.stats.trace.frame_ns) == 1);
+    CHECK(encoder.stats.trace.frame_bytes.sum == GOOD_PACKET.decoded.size());
+  }
+#endif
+}
+
+struct FrameCollector {
+  std::vector<std::vector<uint8_t>> frames;
+  std::vector<bool> malformed;
+
+  static void on_frame(dut::slipc_io_user_ctx_t uctx, uint8_t const *frame,
+                       size_t len, bool malformed) {
+    auto &ctx = *static_cast<FrameCollector *>(uctx.ctx);
+    ctx.frames.emplace_back(frame, frame + len);
+    ctx.malformed.push_back(malformed);
+  }
+};
+
+TEST_CASE("Framer", "[decode]") {
+  std::vector<uint8_t> input = NOISY_PACKET.encoded;
+  input.insert(input.end(), MALFORMED_PACKET_WITH_START.encoded.begin(),
+               MALFORMED_PACKET_WITH_START.encoded.end());
+  input.insert(input.end(), GOOD_PACKET_WITH_START.encoded.begin(),
+               GOOD_PACKET_WITH_START.encoded.end());
+
+  FrameCollector collector;
+  uint8_t buf[32];
+  dut::slipc_framer_t framer;
+
+  SECTION("Chunked input") {
+    auto chunk_len = GENERATE(1u, 3u, 16u, 1024u);
+    dut::slipc_framer_init(&framer, true, buf, sizeof(buf),
+                           FrameCollector::on_frame, {&collector});
+
+    size_t frames = 0;
+    for (size_t pos = 0; pos < input.size(); pos += chunk_len) {
+      size_t len = std::min<size_t>(chunk_len, input.size() - pos);
+      frames += dut::slipc_framer_feed(&framer, input.data() + pos, len);
+    }
+
+    CHECK(frames == 3);
+    REQUIRE(collector.frames.size() == 3);
+    CHECK(collector.frames[0] == NOISY_PACKET.decoded);
+    CHECK(collector.frames[1] == MALFORMED_PACKET.decoded);
+    CHECK(collector.frames[2] == GOOD_PACKET.decoded);
+    CHECK(collector.malformed == std::vector<bool>{false, true, false});
+  }
+
+  SECTION("Oversize frames are dropped") {
+    dut::slipc_framer_init(&framer, true, buf, 12, FrameCollector::on_frame,
+                           {&collector});
+
+    CHECK(dut::slipc_framer_feed(&framer, input.data(), input.size()) == 2);
+    REQUIRE(collector.frames.size() == 2);
+    CHECK(collector.frames[0] == NOISY_PACKET.decoded);
+    CHECK(collector.frames[1] == GOOD_PACKET.decoded);
+  }
+}
+
+TEST_CASE("Channel manager", "[decode]") {
+  constexpr size_t channels = 64;
+  constexpr size_t frame_size = 128;
+  std::mt19937 rng(30);
+  auto startbyte = GENERATE(false, true);
+
+  std::vector<uint8_t> arena(
+      dut::slipc_mux_arena_size(channels, frame_size));
+  dut::slipc_mux_t mux;
+  dut::slipc_mux_init(&mux, startbyte, channels, frame_size, arena.data(),
+                      arena.size());
+
+  // Every channel gets its own stream, checked against a framer each.
+  std::vector<std::vector<uint8_t>> streams(channels);
+  std::vector<FrameCollector> got(channels);
+  std::vector<FrameCollector> want(channels);
+  std::vector<std::vector<uint8_t>> framer_bufs(
+      channels, std::vector<uint8_t>(frame_size));
+  std::vector<dut::slipc_framer_t> framers(channels);
+  for (size_t ch = 0; ch < channels; ch++) {
+    for (int i = 0; i < 6; i++) {
+      std::uniform_int_distribution<size_t> len_dist(1, frame_size + 20);
+      auto payload = random_payload(rng, len_dist(rng), 100);
+      VecWriter writer;
+      REQUIRE(dut::slipc_encode_packet(&writer, payload.data(),
+                                       payload.size(), startbyte) ==
+              dut::slipc_encoder_result_t::SLIPC_ENCODER_OK);
+      streams[ch].insert(streams[ch].end(), writer.buf.begin(),
+                         writer.buf.end());
+    }
+    // Malformed frame and an incomplete one at the end.
+    streams[ch].insert(streams[ch].end(), MALFORMED_PACKET.encoded.begin(),
+                       MALFORMED_PACKET.encoded.end());
+    streams[ch].insert(streams[ch].end(), {1, 2, 3});
+
+    dut::slipc_mux_set_handler(&mux, ch, FrameCollector::on_frame,
+                               {&got[ch]});
+    dut::slipc_framer_init(&framers[ch], startbyte, framer_bufs[ch].data(),
+                           frame_size, FrameCollector::on_frame,
+                           {&want[ch]});
+    dut::slipc_framer_feed(&framers[ch], streams[ch].data(),
+                           streams[ch].size());
+  }
+
+  // Round robin over the channels with chunks of random length.
+  std::vector<size_t> pos(channels);
+  std::vector<dut::slipc_mux_input_t> batch;
+  bool more = true;
+  while (more) {
+    more = false;
+    for (size_t ch = 0; ch < channels; ch++) {
+      std::uniform_int_distribution<size_t> chunk_dist(0, 40);
+      size_t len = std::min(chunk_dist(rng), streams[ch].size() - pos[ch]);
+      batch.push_back({ch, streams[ch].data() + pos[ch], len});
+      pos[ch] += len;
+      more |= pos[ch] < streams[ch].size();
+    }
+  }
+
+  size_t frames = 0;
+  SECTION("Batch") {
+    frames = dut::slipc_mux_feed_batch(&mux, batch.data(), batch.size());
+  }
+  SECTION("Single chunks") {
+    for (auto const &input : batch) {
+      frames += dut::slipc_mux_feed(&mux, input.channel, input.buf, input.len);
+    }
+  }
+
+  size_t want_frames = 0;
+  for (size_t ch = 0; ch < channels; ch++) {
+    INFO("Channel " << ch);
+    CHECK(got[ch].frames == want[ch].frames);
+    CHECK(got[ch].malformed == want[ch].malformed);
+    CHECK(mux.frames[ch] == want[ch].frames.size());
+    CHECK(mux.flags[ch] != 0);
+    want_frames += want[ch].frames.size();
+  }
+  CHECK(frames == want_frames);
+
+  // Reset drops the incomplete frame.
+  dut::slipc_mux_reset(&mux, 0);
+  uint8_t const end = dut::slipc_char_t::SLIPC_END;
+  size_t const before = got[0].frames.size();
+  CHECK(dut::slipc_mux_feed(&mux, 0, &end, 1) == (startbyte ? 0u : 1u));
+  if (!startbyte) {
+    REQUIRE(got[0].frames.size() == before + 1);
+    CHECK(got[0].frames.back().empty());
+  }
+}
+
+TEST_CASE("Channel manager drops frames", "[decode]") {
+  using K = dut::slipc_crc_kind_t;
+
+  alignas(void *) uint8_t arena[256];
+  REQUIRE(dut::slipc_mux_arena_size(2, 12) <= sizeof(arena));
+  dut::slipc_mux_t mux;
+  dut::slipc_mux_init(&mux, true, 2, 12, arena, sizeof(arena));
+
+  FrameCollector collector;
+  dut::slipc_mux_set_handler(&mux, 1, FrameCollector::on_frame, {&collector});
+
+  SECTION("Oversize") {
+    std::vector<uint8_t> input = NOISY_PACKET.encoded;
+    input.insert(input.end(), MALFORMED_PACKET_WITH_START.encoded.begin(),
+                 MALFORMED_PACKET_WITH_START.encoded.end());
+    input.insert(input.end(), GOOD_PACKET_WITH_START.encoded.begin(),
+                 GOOD_PACKET_WITH_START.encoded.end());
+
+    CHECK(dut::slipc_mux_feed(&mux, 1, input.data(), input.size()) == 2);
+    REQUIRE(collector.frames.size() == 2);
+    CHECK(collector.frames[0] == NOISY_PACKET.decoded);
+    CHECK(collector.frames[1] == GOOD_PACKET.decoded);
+    CHECK(mux.dropped[1] == 1);
+
+    // Without a handler frames are counted, but not delivered.
+    CHECK(dut::slipc_mux_feed(&mux, 0, input.data(), input.size()) == 2);
+    CHECK(collector.frames.size() == 2);
+    CHECK(mux.frames[0] == 2);
+  }
+
+  SECTION("Checksum") {
+    dut::slipc_mux_set_crc(&mux, K::SLIPC_CRC_16);
+    std::vector<uint8_t> const payload = {1, 2, 3};
+
+    VecWriter good;
+    REQUIRE(dut::slipc_encode_packet_crc(&good, payload.data(),
+                                         payload.size(), true,
+                                         K::SLIPC_CRC_16) ==
+            dut::slipc_encoder_result_t::SLIPC_ENCODER_OK);
+    auto bad = good.buf;
+    bad[2] ^= 0x10;
+
+    CHECK(dut::slipc_mux_feed(&mux, 1, bad.data(), bad.size()) == 0);
+    CHECK(dut::slipc_mux_feed(&mux, 1, good.buf.data(), good.buf.size()) == 1);
+    REQUIRE(collector.frames.size() == 1);
+    CHECK(collector.frames[0] == payload);
+    CHECK(mux.dropped[1] == 1);
+    CHECK(mux.decoder.stats.crc_errors == 1);
+  }
+}
+
+TEST_CASE("Frame checksums", "[encode][decode]") {
+  using K = dut::slipc_crc_kind_t;
+  using R = dut::slipc_decoder_result_t;
+
+  SECTION("Check values") {
+    std::vector<uint8_t> const check = {'1', '2', '3', '4', '5',
+                                        '6', '7', '8', '9'};
+    CHECK(dut::slipc_crc16(check.data(), check.size()) == 0x29B1);
+    CHECK(dut::slipc_crc32(check.data(), check.size()) == 0xCBF43926);
+
+    // Any split gives the same register as the whole buffer.
+    for (auto kind : {K::SLIPC_CRC_16, K::SLIPC_CRC_32}) {
+      uint32_t whole = dut::slipc_crc_update(kind, dut::slipc_crc_init(kind),
+                                             check.data(), check.size());
+      for (size_t split = 0; split <= check.size(); split++) {
+        uint32_t crc = dut::slipc_crc_init(kind);
+        crc = dut::slipc_crc_update(kind, crc, check.data(), split);
+        crc = dut::slipc_crc_update(kind, crc, check.data() + split,
+                                    check.size() - split);
+        CHECK(crc == whole);
+      }
+    }
+  }
+
+  auto kind = GENERATE(K::SLIPC_CRC_16, K::SLIPC_CRC_32);
+  size_t const crc_len = dut::slipc_crc_size(kind);
+  std::mt19937 rng(kind);
+
+  SECTION("Encode and decode paths agree") {
+    for (size_t len = 1; len < 300; len += 7) {
+      auto payload = random_payload(rng, len, 100);
+      INFO("Length " << len);
+
+      VecWriter encoded;
+      REQUIRE(dut::slipc_encode_packet_crc(&encoded, payload.data(),
+                                           payload.size(), true, kind) ==
+              dut::slipc_encoder_result_t::SLIPC_ENCODER_OK);
+
+      uint8_t trailer[SLIPC_CRC_SIZE_MAX];
+      uint32_t crc = dut::slipc_crc_update(kind, dut::slipc_crc_init(kind),
+                                           payload.data(), payload.size());
+      auto expected = payload;
+      expected.insert(expected.end(), trailer,
+                      trailer + dut::slipc_crc_trailer(kind, crc, trailer));
+      REQUIRE(expected.size() == payload.size() + crc_len);
+
+      auto decoder = dut::slipc_decoder_new(true);
+      dut::slipc_decoder_set_crc(&decoder, kind);
+
+      std::vector<uint8_t> out(expected.size());
+      size_t in_len = encoded.buf.size();
+      size_t out_len = out.size();
+      CHECK(dut::slipc_decoder_feed(&decoder, encoded.buf.data(), &in_len,
+                                    out.data(), &out_len) ==
+            R::SLIPC_DECODER_EOF);
+      CHECK(out == expected);
+
+      VecWriter writer;
+      CHECK(dut::slipc_decoder_decode_packet(&decoder, &writer,
+                                             encoded.buf.data(),
+                                             encoded.buf.size()) ==
+            R::SLIPC_DECODER_EOF);
+      CHECK(writer.buf == expected);
+
+      VecReader reader(encoded.buf);
+      VecWriter transferred;
+      CHECK(dut::slipc_decoder_transfer(&decoder, &reader, &transferred) ==
+            R::SLIPC_DECODER_EOF);
+      CHECK(transferred.buf == expected);
+      CHECK(decoder.stats.crc_errors == 0);
+    }
+  }
+
+  SECTION("Resumable encoders append the checksum") {
+    // Enough frames that some trailers need escaping.
+    size_t escaped_trailers = 0;
+    for (size_t len = 1; len < 300; len++) {
+      auto payload = random_payload(rng, len, 100);
+      INFO("Length " << len);
+
+      VecWriter expected;
+      REQUIRE(dut::slipc_encode_packet_crc(&expected, payload.data(),
+                                           payload.size(), true, kind) ==
+              dut::slipc_encoder_result_t::SLIPC_ENCODER_OK);
+
+      auto encoder = dut::slipc_encoder_new(true);
+      dut::slipc_encoder_set_crc(&encoder, kind);
+      TrickleWriter written(0);
+      dut::slipc_encoder_result_t res;
+      do {
+        written.budget = 1;
+        res = dut::slipc_encoder_write(&encoder, &written, payload.data(),
+                                       payload.size());
+      } while (res == dut::slipc_encoder_result_t::SLIPC_ENCODER_AGAIN);
+      CHECK(res == dut::slipc_encoder_result_t::SLIPC_ENCODER_OK);
+      CHECK(written.buf == expected.buf);
+
+      uint8_t chunk[3];
+      dut::slipc_encoder_set_chunk(&encoder, chunk, sizeof(chunk));
+      VecReader reader(payload);
+      TrickleWriter transferred(0);
+      do {
+        transferred.budget = 1;
+        res = dut::slipc_encoder_transfer(&encoder, &reader, &transferred);
+      } while (res == dut::slipc_encoder_result_t::SLIPC_ENCODER_AGAIN);
+      CHECK(res == dut::slipc_encoder_result_t::SLIPC_ENCODER_OK);
+      CHECK(transferred.buf == expected.buf);
+
+      uint8_t trailer[SLIPC_CRC_SIZE_MAX];
+      uint32_t crc = dut::slipc_crc_update(kind, dut::slipc_crc_init(kind),
+                                           payload.data(), payload.size());
+      size_t const n = dut::slipc_crc_trailer(kind, crc, trailer);
+      escaped_trailers += std::any_of(trailer, trailer + n, [](uint8_t b) {
+        return b == dut::slipc_char_t::SLIPC_END ||
+               b == dut::slipc_char_t::SLIPC_ESC;
+      });
+    }
+    CHECK(escaped_trailers > 0);
+  }
+
+  SECTION("Corrupted frames are reported") {
+    auto payload = random_payload(rng, 64, 0);
+    VecWriter encoded;
+    REQUIRE(dut::slipc_encode_packet_crc(&encoded, payload.data(),
+                                         payload.size(), false, kind) ==
+            dut::slipc_encoder_result_t::SLIPC_ENCODER_OK);
+
+    auto input = encoded.buf;
+    auto &byte = *std::find_if(input.begin(), input.end(), [](uint8_t b) {
+      // Neither the byte nor its corruption may change the framing.
+      uint8_t const flipped = b ^ 1;
+      return b != dut::slipc_char_t::SLIPC_END &&
+             b != dut::slipc_char_t::SLIPC_ESC &&
+             flipped != dut::slipc_char_t::SLIPC_END &&
+             flipped != dut::slipc_char_t::SLIPC_ESC;
+    });
+    byte ^= 1;
+    input.insert(input.end(), encoded.buf.begin(), encoded.buf.end());
+
+    auto decoder = dut::slipc_decoder_new(false);
+    dut::slipc_decoder_set_crc(&decoder, kind);
+
+    std::vector<uint8_t> out(input.size());
+    std::vector<dut::slipc_frame_desc_t> frames(4);
+    size_t len = input.size();
+    size_t count = frames.size();
+    CHECK(dut::slipc_decoder_decode_frames(&decoder, input.data(), &len,
+                                           out.data(), out.size(),
+                                           frames.data(), &count) ==
+          R::SLIPC_DECODER_MORE);
+    REQUIRE(count == 2);
+    CHECK(frames[0].crc_error);
+    CHECK_FALSE(frames[1].crc_error);
+    CHECK(frames[1].len == payload.size() + crc_len);
+    CHECK(decoder.stats.crc_errors == 1);
+
+    VecWriter writer;
+    CHECK(dut::slipc_decoder_decode_packet(&decoder, &writer, input.data(),
+                                           encoded.buf.size()) ==
+          R::SLIPC_DECODER_CRC_ERROR);
+    CHECK(decoder.stats.crc_errors == 2);
+  }
+
+  SECTION("Framer drops corrupted frames and the checksum") {
+    auto payload = random_payload(rng, 20, 100);
+    VecWriter encoded;
+    REQUIRE(dut::slipc_encode_packet_crc(&encoded, payload.data(),
+                                         payload.size(), true, kind) ==
+            dut::slipc_encoder_result_t::SLIPC_ENCODER_OK);
+
+    auto input = encoded.buf;
+    input[input.size() - 2] ^= 1;
+    input.insert(input.end(), encoded.buf.begin(), encoded.buf.end());
+
+    FrameCollector collector;
+    uint8_t buf[64];
+    dut::slipc_framer_t framer;
+    dut::slipc_framer_init(&framer, true, buf, sizeof(buf),
+                           FrameCollector::on_frame, {&collector});
+    dut::slipc_decoder_set_crc(&framer.decoder, kind);
+
+    CHECK(dut::slipc_framer_feed(&framer, input.data(), input.size()) == 1);
+    REQUIRE(collector.frames.size() == 1);
+    CHECK(collector.frames[0] == payload);
+  }
+}
+
+struct PoolCollector {
+  dut::slipc_pool_t *pool;
+  std::vector<uint8_t const *> held;
+  std::vector<std::vector<uint8_t>> frames;
+
+  static void on_frame(dut::slipc_io_user_ctx_t uctx, uint8_t const *frame,
+                       size_t len, bool) {
+    auto &ctx = *static_cast<PoolCollector *>(uctx.ctx);
+    ctx.held.push_back(frame);
+    ctx.frames.emplace_back(frame, frame + len);
+  }
+
+  void release() {
+    for (auto frame : held) {
+      dut::slipc_pool_release(pool, const_cast<uint8_t *>(frame));
+    }
+    held.clear();
+  }
+};
+
+TEST_CASE("Frame pool", "[decode]") {
+  alignas(void *) uint8_t arena[3 * 32 + 5];
+  dut::slipc_pool_t pool;
+  dut::slipc_pool_init(&pool, arena, sizeof(arena), 30);
+
+  SECTION("Acquire and release") {
+    CHECK(pool.available == 3);
+    uint8_t *a = dut::slipc_pool_acquire(&pool);
+    uint8_t *b = dut::slipc_pool_acquire(&pool);
+    uint8_t *c = dut::slipc_pool_acquire(&pool);
+    CHECK(a == arena);
+    CHECK(b == arena + 32);
+    CHECK(c == arena + 64);
+    CHECK(dut::slipc_pool_acquire(&pool) == nullptr);
+    CHECK(pool.available == 0);
+
+    dut::slipc_pool_release(&pool, b);
+    CHECK(pool.available == 1);
+    CHECK(dut::slipc_pool_acquire(&pool) == b);
+  }
+
+  SECTION("Framer hands out pool frames") {
+    std::vector<uint8_t> input;
+    for (int i = 0; i < 4; i++) {
+      input.insert(input.end(), GOOD_PACKET_WITH_START.encoded.begin(),
+                   GOOD_PACKET_WITH_START.encoded.end());
+    }
+
+    PoolCollector collector{&pool, {}, {}};
+    dut::slipc_framer_t framer;
+    dut::slipc_framer_init_pool(&framer, true, &pool, PoolCollector::on_frame,
+                                {&collector});
+
+    // Only three frames fit, the fourth is dropped until frames come back.
+    CHECK(dut::slipc_framer_feed(&framer, input.data(), input.size()) == 3);
+    REQUIRE(collector.frames.size() == 3);
+    for (size_t i = 0; i < collector.held.size(); i++) {
+      CHECK(collector.held[i] == arena + 32 * i);
+      CHECK(collector.frames[i] == GOOD_PACKET.decoded);
+    }
+
+    collector.release();
+    CHECK(dut::slipc_framer_feed(&framer, input.data(), input.size()) == 3);
+    CHECK(collector.frames.size() == 6);
+    CHECK(collector.frames.back() == GOOD_PACKET.decoded);
+
+    collector.release();
+    dut::slipc_framer_deinit(&framer);
+    CHECK(pool.available == 3);
+  }
+}
+
+TEST_CASE("Parallel capture decode", "[decode]") {
+  std::mt19937 rng(20);
+  auto startbyte = GENERATE(false, true);
+
+  std::vector<std::vector<uint8_t>> payloads;
+  std::vector<uint8_t> capture;
+  for (int i = 0; i < 200; i++) {
+    std::uniform_int_distribution<size_t> len_dist(1, 300);
+    payloads.push_back(random_payload(rng, len_dist(rng), 50));
+    VecWriter writer;
+    REQUIRE(dut::slipc_encode_packet(&writer, payloads.back().data(),
+                                     payloads.back().size(), startbyte) ==
+            dut::slipc_encoder_result_t::SLIPC_ENCODER_OK);
+    capture.insert(capture.end(), writer.buf.begin(), writer.buf.end());
+  }
+  size_t const complete = capture.size();
+  capture.insert(capture.end(), {1, dut::slipc_char_t::SLIPC_ESC});
+
+  std::vector<uint8_t> out(capture.size());
+  std::vector<dut::slipc_frame_desc_t> frames(payloads.size());
+
+  SECTION("All frames") {
+    auto threads = GENERATE(1u, 2u, 3u, 8u);
+    size_t len = capture.size();
+    size_t count = frames.size();
+    CHECK(dut::slipc_decode_parallel(capture.data(), &len, out.data(),
+                                     frames.data(), &count, threads) ==
+          dut::slipc_decoder_result_t::SLIPC_DECODER_MORE);
+    CHECK(len == complete);
+    REQUIRE(count == payloads.size());
+    for (size_t i = 0; i < count; i++) {
+      auto const begin = out.begin() + frames[i].offset;
+      CHECK(std::vector<uint8_t>(begin, begin + frames[i].len) ==
+            payloads[i]);
+    }
+  }
+
+  SECTION("Frames array full") {
+    auto threads = GENERATE(1u, 4u);
+    std::vector<std::vector<uint8_t>> decoded;
+    size_t pos = 0;
+    dut::slipc_decoder_result_t res;
+    do {
+      size_t len = capture.size() - pos;
+      size_t count = 7;
+      res = dut::slipc_decode_parallel(capture.data() + pos, &len, out.data(),
+                                       frames.data(), &count, threads);
+      for (size_t i = 0; i < count; i++) {
+        auto const begin = out.begin() + frames[i].offset;
+        decoded.emplace_back(begin, begin + frames[i].len);
+      }
+      pos += len;
+    } while (res == dut::slipc_decoder_result_t::SLIPC_DECODER_EOF);
+
+    CHECK(pos == complete);
+    CHECK(decoded == payloads);
+  }
+}
+
+TEST_CASE("Memory mapped files", "[io]") {
+  auto const path =
+      (std::filesystem::temp_directory_path() / "slipc_test_mmap.bin").string();
+
+  SECTION("Write and read back") {
+    dut::slipc_io_mmap_writer_t mmap_writer;
+    auto writer =
+        dut::slipc_io_writer_from_mmap(&mmap_writer, path.c_str(), 4096);
+    for (int i = 0; i < 3; i++) {
+      REQUIRE(dut::slipc_encode_packet(&writer, GOOD_PACKET.decoded.data(),
+                                       GOOD_PACKET.decoded.size(), false) ==
+              dut::slipc_encoder_result_t::SLIPC_ENCODER_OK);
+    }
+    CHECK(dut::slipc_io_mmap_writer_close(&mmap_writer));
+    CHECK(std::filesystem::file_size(path) == 3 * GOOD_PACKET.encoded.size());
+
+    dut::slipc_io_mmap_reader_t mmap_reader;
+    auto reader = dut::slipc_io_reader_from_mmap(&mmap_reader, path.c_str());
+    REQUIRE(mmap_reader.map != nullptr);
+    CHECK(std::vector<uint8_t>(mmap_reader.map,
+                               mmap_reader.map + GOOD_PACKET.encoded.size()) ==
+          GOOD_PACKET.encoded);
+
+    auto decoder = dut::slipc_decoder_new(false);
+    for (int i = 0; i < 3; i++) {
+      VecWriter decoded;
+      CHECK(dut::slipc_decoder_transfer(&decoder, &reader, &decoded) ==
+            dut::slipc_decoder_result_t::SLIPC_DECODER_EOF);
+      CHECK(decoded.buf == GOOD_PACKET.decoded);
+    }
+    dut::slipc_io_mmap_reader_close(&mmap_reader);
+  }
+
+  SECTION("Writer capacity") {
+    dut::slipc_io_mmap_writer_t mmap_writer;
+    size_t const capacity = GOOD_PACKET.encoded.size() - 1;
+    auto writer =
+        dut::slipc_io_writer_from_mmap(&mmap_writer, path.c_str(), capacity);
+    CHECK(dut::slipc_encode_packet(&writer, GOOD_PACKET.decoded.data(),
+                                   GOOD_PACKET.decoded.size(), false) ==
+          dut::slipc_encoder_result_t::SLIPC_ENCODER_IO_ERROR);
+    CHECK(dut::slipc_io_mmap_writer_close(&mmap_writer));
+  }
+
+  SECTION("Empty file") {
+    dut::slipc_io_mmap_writer_t mmap_writer;
+    dut::slipc_io_writer_from_mmap(&mmap_writer, path.c_str(), 16);
+    CHECK(dut::slipc_io_mmap_writer_close(&mmap_writer));
+
+    dut::slipc_io_mmap_reader_t mmap_reader;
+    auto reader = dut::slipc_io_reader_from_mmap(&mmap_reader, path.c_str());
+    uint8_t byte;
+    size_t len = 1;
+    CHECK(dut::slipc_io_reader_read(&reader, &byte, &len) ==
+          dut::slipc_io_reader_result_t::SLIPC_IO_READER_EOF);
+    CHECK(len == 0);
+    dut::slipc_io_mmap_reader_close(&mmap_reader);
+  }
+
+  SECTION("Missing file") {
+    dut::slipc_io_mmap_reader_t mmap_reader;
+    auto reader = dut::slipc_io_reader_from_mmap(
+        &mmap_reader, (path + ".missing/file").c_str());
+    uint8_t byte;
+    size_t len = 1;
+    CHECK(dut::slipc_io_reader_read(&reader, &byte, &len) ==
+          dut::slipc_io_reader_result_t::SLIPC_IO_READER_ERROR);
+  }
+
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("File descriptors", "[io]") {
+  int fds[2];
+  REQUIRE(pipe(fds) == 0);
+  REQUIRE(dut::slipc_io_fd_set_nonblocking(fds[0], true));
+  REQUIRE(dut::slipc_io_fd_set_nonblocking(fds[1], true));
+
+  uint8_t read_buf[16];
+  dut::slipc_io_fd_reader_t fd_reader;
+  auto reader = dut::slipc_io_reader_from_fd(&fd_reader, fds[0], read_buf,
+                                             sizeof(read_buf));
+  uint8_t write_buf[64];
+  dut::slipc_io_fd_writer_t fd_writer;
+  auto writer = dut::slipc_io_writer_from_fd(&fd_writer, fds[1], write_buf,
+                                             sizeof(write_buf));
+
+  SECTION("Writes are coalesced until END") {
+    uint8_t const data[] = {1, 2, 3};
+    size_t len = sizeof(data);
+    CHECK(dut::slipc_io_writer_write(&writer, data, &len) ==
+          dut::slipc_io_writer_result_t::SLIPC_IO_WRITER_OK);
+    CHECK(fd_writer.len == sizeof(data));
+
+    uint8_t byte;
+    len = 1;
+    CHECK(dut::slipc_io_reader_read(&reader, &byte, &len) ==
+          dut::slipc_io_reader_result_t::SLIPC_IO_READER_AGAIN);
+    CHECK(len == 0);
+
+    REQUIRE(dut::slipc_encode_packet(&writer, GOOD_PACKET.decoded.data(),
+                                     GOOD_PACKET.decoded.size(), false) ==
+            dut::slipc_encoder_result_t::SLIPC_ENCODER_OK);
+    CHECK(fd_writer.len == 0);
+
+    std::vector<uint8_t> expected(data, data + sizeof(data));
+    expected.insert(expected.end(), GOOD_PACKET.encoded.begin(),
+                    GOOD_PACKET.encoded.end());
+    std::vector<uint8_t> got(expected.size());
+    len = got.size();
+    CHECK(dut::slipc_io_reader_read(&reader, got.data(), &len) ==
+          dut::slipc_io_reader_result_t::SLIPC_IO_READER_MORE);
+    CHECK(len == expected.size());
+    CHECK(got == expected);
+  }
+
+  SECTION("Frame fills the buffer exactly") {
+    auto startbyte = GENERATE(false, true);
+    uint8_t small_buf[4];
+    dut::slipc_io_fd_writer_t small;
+    auto small_writer = dut::slipc_io_writer_from_fd(&small, fds[1], small_buf,
+                                                     sizeof(small_buf));
+    std::vector<uint8_t> const payload(sizeof(small_buf) - startbyte, 1);
+
+    VecWriter expected;
+    REQUIRE(dut::slipc_encode_packet(&expected, payload.data(),
+                                     payload.size(), startbyte) ==
+            dut::slipc_encoder_result_t::SLIPC_ENCODER_OK);
+    CHECK(dut::slipc_encode_packet(&small_writer, payload.data(),
+                                   payload.size(), startbyte) ==
+          dut::slipc_encoder_result_t::SLIPC_ENCODER_OK);
+    CHECK(small.len == 0);
+
+    std::vector<uint8_t> got(expected.buf.size() + 1);
+    size_t len = got.size();
+    CHECK(dut::slipc_io_reader_read(&reader, got.data(), &len) ==
+          dut::slipc_io_reader_result_t::SLIPC_IO_READER_MORE);
+    got.resize(len);
+    CHECK(got == expected.buf);
+  }
+
+  SECTION("Decoder resumes after would block") {
+    auto decoder = dut::slipc_decoder_new(true);
+    VecWriter decoded;
+    CHECK(dut::slipc_decoder_transfer(&decoder, &reader, &decoded) ==
+          dut::slipc_decoder_result_t::SLIPC_DECODER_AGAIN);
+
+    std::vector<uint8_t> packet = {dut::slipc_char_t::SLIPC_END};
+    packet.insert(packet.end(), GOOD_PACKET.encoded.begin(),
+                  GOOD_PACKET.encoded.end());
+    REQUIRE(write(fds[1], packet.data(), 3) == 3);
+    CHECK(dut::slipc_decoder_transfer(&decoder, &reader, &decoded) ==
+          dut::slipc_decoder_result_t::SLIPC_DECODER_AGAIN);
+
+    auto const rest = static_cast<ssize_t>(packet.size() - 3);
+    REQUIRE(write(fds[1], packet.data() + 3, packet.size() - 3) == rest);
+    CHECK(dut::slipc_decoder_transfer(&decoder, &reader, &decoded) ==
+          dut::slipc_decoder_result_t::SLIPC_DECODER_EOF);
+    CHECK(decoded.buf == GOOD_PACKET.decoded);
+
+    close(fds[1]);
+    fds[1] = -1;
+    CHECK(dut::slipc_decoder_transfer(&decoder, &reader, &decoded) ==
+          dut::slipc_decoder_result_t::SLIPC_DECODER_NOT_FOUND);
+  }
+
+  SECTION("Encoder resumes after would block") {
+    auto encoder = dut::slipc_encoder_new(false);
+    VecWriter encoded;
+    CHECK(dut::slipc_encoder_transfer(&encoder, &reader, &encoded) ==
+          dut::slipc_encoder_result_t::SLIPC_ENCODER_AGAIN);
+
+    auto const &payload = GOOD_PACKET.decoded;
+    REQUIRE(write(fds[1], payload.data(), 2) == 2);
+    CHECK(dut::slipc_encoder_transfer(&encoder, &reader, &encoded) ==
+          dut::slipc_encoder_result_t::SLIPC_ENCODER_AGAIN);
+
+    auto const rest = static_cast<ssize_t>(payload.size() - 2);
+    REQUIRE(write(fds[1], payload.data() + 2, payload.size() - 2) == rest);
+    close(fds[1]);
+    fds[1] = -1;
+    CHECK(dut::slipc_encoder_transfer(&encoder, &reader, &encoded) ==
+          dut::slipc_encoder_result_t::SLIPC_ENCODER_OK);
+    CHECK(encoded.buf == GOOD_PACKET.encoded);
+  }
+
+  SECTION("Writer would block on a full pipe") {
+    std::vector<uint8_t> fill(4096, 1);
+    while (write(fds[1], fill.data(), fill.size()) > 0) {
+    }
+
+    std::vector<uint8_t> data(100, 2);
+    size_t len = data.size();
+    CHECK(dut::slipc_io_writer_write(&writer, data.data(), &len) ==
+          dut::slipc_io_writer_result_t::SLIPC_IO_WRITER_AGAIN);
+    CHECK(len == sizeof(write_buf));
+    CHECK(dut::slipc_io_fd_writer_flush(&fd_writer) ==
+          dut::slipc_io_writer_result_t::SLIPC_IO_WRITER_AGAIN);
+
+    while (read(fds[0], fill.data(), fill.size()) > 0) {
+    }
+    CHECK(dut::slipc_io_fd_writer_flush(&fd_writer) ==
+          dut::slipc_io_writer_result_t::SLIPC_IO_WRITER_OK);
+    CHECK(fd_writer.len == 0);
+  }
+
+  close(fds[0]);
+  if (fds[1] >= 0) {
+    close(fds[1]);
+  }
+}
+
+TEST_CASE("Ring buffer", "[io]") {
+  uint8_t storage[16];
+  dut::slipc_io_ring_t ring;
+  dut::slipc_io_ring_init(&ring, storage, sizeof(storage));
+
+  SECTION("Peek and commit wrap around") {
+    size_t len;
+    uint8_t *dst = dut::slipc_io_ring_write_peek(&ring, &len);
+    CHECK(len == sizeof(storage));
+    std::fill_n(dst, 12, 1);
+    dut::slipc_io_ring_write_commit(&ring, 12);
+
+    dut::slipc_io_ring_read_peek(&ring, &len);
+    CHECK(len == 12);
+    dut::slipc_io_ring_read_commit(&ring, 10);
+
+    dst = dut::slipc_io_ring_write_peek(&ring, &len);
+    CHECK(len == 4);
+    CHECK(dst == storage + 12);
+    dut::slipc_io_ring_write_commit(&ring, 4);
+
+    dst = dut::slipc_io_ring_write_peek(&ring, &len);
+    CHECK(len == 10);
+    CHECK(dst == storage);
+  }
+
+  SECTION("Encode and transfer decode through the ring") {
+    auto writer = dut::slipc_io_writer_from_ring(&ring);
+    auto reader = dut::slipc_io_reader_from_ring(&ring);
+    auto decoder = dut::slipc_decoder_new(false);
+
+    for (int i = 0; i < 4; i++) {
+      auto res =
+          dut::slipc_encode_packet(&writer, GOOD_PACKET.decoded.data(),
+                                   GOOD_PACKET.decoded.size(), false);
+      REQUIRE(res == dut::slipc_encoder_result_t::SLIPC_ENCODER_OK);
+
+      VecWriter decoded;
+      CHECK(dut::slipc_decoder_transfer(&decoder, &reader, &decoded) ==
+            dut::slipc_decoder_result_t::SLIPC_DECODER_EOF);
+      CHECK(decoded.buf == GOOD_PACKET.decoded);
+    }
+  }
+
+  SECTION("Transfer resumes a frame split across fills") {
+    auto writer = dut::slipc_io_writer_from_ring(&ring);
+    auto reader = dut::slipc_io_reader_from_ring(&ring);
+    auto decoder = dut::slipc_decoder_new(true);
+    VecWriter decoded;
+
+    uint8_t const first[] = {dut::slipc_char_t::SLIPC_END, 1, 2, 3};
+    size_t len = sizeof(first);
+    REQUIRE(dut::slipc_io_writer_write(&writer, first, &len) ==
+            dut::slipc_io_writer_result_t::SLIPC_IO_WRITER_OK);
+    CHECK(dut::slipc_decoder_transfer(&decoder, &reader, &decoded) ==
+          dut::slipc_decoder_result_t::SLIPC_DECODER_AGAIN);
+
+    uint8_t const second[] = {4, 5, dut::slipc_char_t::SLIPC_END};
+    len = sizeof(second);
+    REQUIRE(dut::slipc_io_writer_write(&writer, second, &len) ==
+            dut::slipc_io_writer_result_t::SLIPC_IO_WRITER_OK);
+    CHECK(dut::slipc_decoder_transfer(&decoder, &reader, &decoded) ==
+          dut::slipc_decoder_result_t::SLIPC_DECODER_EOF);
+    CHECK(decoded.buf == std::vector<uint8_t>{1, 2, 3, 4, 5});
+
+    // Nothing more written yet.
+    VecWriter next;
+    CHECK(dut::slipc_decoder_transfer(&decoder, &reader, &next) ==
+          dut::slipc_decoder_result_t::SLIPC_DECODER_AGAIN);
+  }
+
+  SECTION("Writer reports a full ring") {
+    auto writer = dut::slipc_io_writer_from_ring(&ring);
+    uint8_t const data[20] = {};
+    size_t len = sizeof(data);
+    CHECK(dut::slipc_io_writer_write(&writer, data, &len) ==
+          dut::slipc_io_writer_result_t::SLIPC_IO_WRITER_EOF);
+    CHECK(len == sizeof(storage));
+  }
+
+  SECTION("Producer and consumer threads") {
+    size_t const frame_count = 2000;
+    auto const encoded = MALFORMED_PACKET.encoded;
+
+    std::thread producer([&]() {
+      for (size_t i = 0; i < frame_count; i++) {
+        size_t pos = 0;
+        while (pos < encoded.size()) {
+          size_t len;
+          uint8_t *dst = dut::slipc_io_ring_write_peek(&ring, &len);
+          if (len == 0) {
+            std::this_thread::yield();
+            continue;
+          }
+          len = std::min(len, encoded.size() - pos);
+          std::copy_n(encoded.begin() + pos, len, dst);
+          dut::slipc_io_ring_write_commit(&ring, len);
+          pos += len;
+        }
+      }
+    });
+
+    auto decoder = dut::slipc_decoder_new(false);
+    std::vector<uint8_t> frame;
+    size_t frames = 0;
+    bool all_good = true;
+
+    while (frames < frame_count) {
+      size_t len;
+      uint8_t const *src = dut::slipc_io_ring_read_peek(&ring, &len);
+      if (len == 0) {
+        std::this_thread::yield();
+        continue;
+      }
+      uint8_t out[32];
+      size_t out_len = sizeof(out);
+      auto res = dut::slipc_decoder_feed(&decoder, src, &len, out, &out_len);
+      dut::slipc_io_ring_read_commit(&ring, len);
+
+      frame.insert(frame.end(), out, out + out_len);
+      if (res == dut::slipc_decoder_result_t::SLIPC_DECODER_EOF) {
+        all_good = all_good && frame == MALFORMED_PACKET.decoded;
+        frame.clear();
+        frames++;
+      }
+    }
+    producer.join();
+
+    CHECK(all_good);
+  }
+}
+
+struct FakeDma {
+  std::vector<std::vector<uint8_t>> transfers;
+  std::vector<uint8_t const *> buffers;
+  /** Completes every transfer right away if set */
+  dut::slipc_io_dma_writer_t *instant = nullptr;
+
+  static void start_cb(dut::slipc_io_user_ctx_t uctx, uint8_t const *data,
+                       size_t len) {
+    auto &ctx = *static_cast<FakeDma *>(uctx.ctx);
+    ctx.transfers.emplace_back(data, data + len);
+    ctx.buffers.push_back(data);
+    if (ctx.instant) {
+      dut::slipc_io_dma_writer_complete(ctx.instant);
+    }
+  }
+};
+
+TEST_CASE("DMA writer", "[io]") {
+  alignas(32) uint8_t buf_a[16];
+  alignas(32) uint8_t buf_b[16];
+  FakeDma dma;
+  dut::slipc_io_dma_writer_t dma_writer;
+  auto writer = dut::slipc_io_writer_from_dma(
+      &dma_writer, buf_a, buf_b, sizeof(buf_a), FakeDma::start_cb, {&dma});
+
+  SECTION("Frames are sent on END") {
+    REQUIRE(dut::slipc_encode_packet(&writer, GOOD_PACKET.decoded.data(),
+                                     GOOD_PACKET.decoded.size(), false) ==
+            dut::slipc_encoder_result_t::SLIPC_ENCODER_OK);
+    REQUIRE(dma.transfers.size() == 1);
+    CHECK(dma.transfers[0] == GOOD_PACKET.encoded);
+    CHECK(dma.buffers[0] == buf_a);
+
+    // Collected while the first transfer runs.
+    REQUIRE(dut::slipc_encode_packet(&writer, GOOD_PACKET.decoded.data(),
+                                     GOOD_PACKET.decoded.size(), false) ==
+            dut::slipc_encoder_result_t::SLIPC_ENCODER_OK);
+    CHECK(dma.transfers.size() == 1);
+
+    dut::slipc_io_dma_writer_complete(&dma_writer);
+    REQUIRE(dma.transfers.size() == 2);
+    CHECK(dma.transfers[1] == GOOD_PACKET.encoded);
+    CHECK(dma.buffers[1] == buf_b);
+
+    dut::slipc_io_dma_writer_complete(&dma_writer);
+    CHECK(dma.transfers.size() == 2);
+  }
+
+  SECTION("Frames span buffers") {
+    std::vector<uint8_t> payload(30);
+    for (size_t i = 0; i < payload.size(); i++) {
+      payload[i] = static_cast<uint8_t>(i % 3 ? i : 0xC0);
+    }
+    std::vector<uint8_t> expected(SLIPC_ENCODED_SIZE_MAX(payload.size(), true));
+    dut::slipc_io_buffer_writer_t buffer;
+    auto buffer_writer = dut::slipc_io_writer_from_buffer(
+        &buffer, expected.data(), expected.size());
+    REQUIRE(dut::slipc_encode_packet(&buffer_writer, payload.data(),
+                                     payload.size(), true) ==
+            dut::slipc_encoder_result_t::SLIPC_ENCODER_OK);
+    expected.resize(expected.size() - buffer.len);
+
+    auto encoder = dut::slipc_encoder_new(true);
+    dut::slipc_encoder_result_t res;
+    size_t calls = 0;
+    while ((res = dut::slipc_encoder_write(&encoder, &writer, payload.data(),
+                                           payload.size())) ==
+               dut::slipc_encoder_result_t::SLIPC_ENCODER_AGAIN &&
+           calls++ < 100) {
+      dut::slipc_io_dma_writer_complete(&dma_writer);
+    }
+    CHECK(res == dut::slipc_encoder_result_t::SLIPC_ENCODER_OK);
+    CHECK(calls > 0);
+    // The frame goes out on its own, without a flush.
+    for (size_t sent = 0; sent != dma.transfers.size();) {
+      sent = dma.transfers.size();
+      dut::slipc_io_dma_writer_complete(&dma_writer);
+    }
+    CHECK(dma_writer.len == 0);
+
+    std::vector<uint8_t> sent;
+    for (size_t i = 0; i < dma.transfers.size(); i++) {
+      CHECK(dma.buffers[i] == (i % 2 ? buf_b : buf_a));
+      CHECK(dma.transfers[i].size() <= sizeof(buf_a));
+      sent.insert(sent.end(), dma.transfers[i].begin(),
+                  dma.transfers[i].end());
+    }
+    CHECK(sent == expected);
+  }
+
+  SECTION("Frame fills a buffer exactly") {
+    auto startbyte = GENERATE(false, true);
+    dma.instant = &dma_writer;
+    std::vector<uint8_t> const payload(sizeof(buf_a) - startbyte, 1);
+
+    for (int i = 0; i < 2; i++) {
+      CHECK(dut::slipc_encode_packet(&writer, payload.data(), payload.size(),
+                                     startbyte) ==
+            dut::slipc_encoder_result_t::SLIPC_ENCODER_OK);
+      CHECK(dma_writer.len == 0);
+    }
+
+    std::vector<uint8_t> frame;
+    if (startbyte) {
+      frame.push_back(dut::slipc_char_t::SLIPC_END);
+    }
+    frame.insert(frame.end(), payload.begin(), payload.end());
+    std::vector<uint8_t> const end = {dut::slipc_char_t::SLIPC_END};
+    CHECK(dma.transfers ==
+          std::vector<std::vector<uint8_t>>{frame, end, frame, end});
+  }
+
+  SECTION("Flush") {
+    uint8_t const data[] = {1, 2, 3};
+    size_t len = sizeof(data);
+    CHECK(dut::slipc_io_writer_write(&writer, data, &len) ==
+          dut::slipc_io_writer_result_t::SLIPC_IO_WRITER_OK);
+    CHECK(dma.transfers.empty());
+
+    CHECK(dut::slipc_io_dma_writer_flush(&dma_writer) ==
+          dut::slipc_io_writer_result_t::SLIPC_IO_WRITER_OK);
+    REQUIRE(dma.transfers.size() == 1);
+    CHECK(dma.transfers[0] == std::vector<uint8_t>(data, data + len));
+
+    len = sizeof(data);
+    dut::slipc_io_writer_write(&writer, data, &len);
+    CHECK(dut::slipc_io_dma_writer_flush(&dma_writer) ==
+          dut::slipc_io_writer_result_t::SLIPC_IO_WRITER_AGAIN);
+    CHECK(dut::slipc_io_dma_writer_flush(&dma_writer) ==
+          dut::slipc_io_writer_result_t::SLIPC_IO_WRITER_AGAIN);
+    dut::slipc_io_dma_writer_complete(&dma_writer);
+    CHECK(dma.transfers.size() == 2);
+    CHECK(dut::slipc_io_dma_writer_flush(&dma_writer) ==
+          dut::slipc_io_writer_result_t::SLIPC_IO_WRITER_OK);
+  }
+}
+
 TEST_CASE("Packet decode", "[decode]") {
   SECTION("Good Packet") {
 
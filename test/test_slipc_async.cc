@@ -0,0 +1,155 @@
+#include "catch2/catch_test_macros.hpp"
+#include "catch2/generators/catch_generators.hpp"
+
+#include <algorithm>
+#include <coroutine>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "slipc_async.hpp"
+
+// Stand-in for an event loop: reads and writes suspend until poll() makes the
+// descriptor ready, at most chunk bytes at a time.
+struct FakeLoop {
+  std::vector<uint8_t> input;
+  std::vector<uint8_t> output;
+  size_t chunk;
+  size_t write_limit = SIZE_MAX;
+
+  std::coroutine_handle<> waiting;
+  std::span<uint8_t> read_dst;
+  std::span<uint8_t const> write_src;
+  size_t transferred = 0;
+
+  struct io_awaiter {
+    FakeLoop &loop;
+    bool await_ready() noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle) noexcept {
+      loop.waiting = handle;
+    }
+    size_t await_resume() noexcept { return loop.transferred; }
+  };
+
+  io_awaiter read(std::span<uint8_t> buf) {
+    read_dst = buf;
+    write_src = {};
+    return {*this};
+  }
+
+  io_awaiter write(std::span<uint8_t const> buf) {
+    write_src = buf;
+    read_dst = {};
+    return {*this};
+  }
+
+  // Complete the pending operation and resume its coroutine.
+  bool poll() {
+    if (!waiting) {
+      return false;
+    }
+
+    if (!read_dst.empty()) {
+      transferred = std::min({chunk, read_dst.size(), input.size()});
+      std::copy_n(input.begin(), transferred, read_dst.begin());
+      input.erase(input.begin(), input.begin() + transferred);
+    } else {
+      transferred = std::min({chunk, write_src.size(), write_limit});
+      output.insert(output.end(), write_src.begin(),
+                    write_src.begin() + transferred);
+      write_limit -= transferred;
+    }
+
+    std::exchange(waiting, {}).resume();
+    return true;
+  }
+};
+
+static slipc::task<std::vector<std::vector<uint8_t>>>
+collect(FakeLoop &loop, bool startbyte, size_t frame_size) {
+  std::vector<uint8_t> frame_buf(frame_size);
+  std::vector<uint8_t> read_buf(16);
+  auto frames = slipc::read_frames(loop, startbyte, frame_buf, read_buf);
+
+  std::vector<std::vector<uint8_t>> result;
+  while (auto const *frame = co_await frames.next()) {
+    result.emplace_back(frame->data.begin(), frame->data.end());
+  }
+  co_return result;
+}
+
+static slipc::task<bool>
+send(FakeLoop &loop, std::vector<std::vector<uint8_t>> const &payloads,
+     bool startbyte, size_t scratch_size) {
+  std::vector<uint8_t> scratch(scratch_size);
+  for (auto const &payload : payloads) {
+    if (!co_await slipc::write_frame(loop, payload, startbyte, scratch)) {
+      co_return false;
+    }
+  }
+  co_return true;
+}
+
+static std::vector<std::vector<uint8_t>> const PAYLOADS{
+    {1, 2, 3},
+    {},
+    {SLIPC_END, SLIPC_ESC, SLIPC_ESC_END, SLIPC_ESC_ESC, SLIPC_END},
+    {7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, SLIPC_ESC},
+};
+
+TEST_CASE("Coroutine frame stream", "[cpp][async]") {
+  auto startbyte = GENERATE(false, true);
+  auto chunk = GENERATE(size_t{1}, size_t{5}, size_t{64});
+  auto scratch_size = GENERATE(size_t{2}, size_t{3}, size_t{64});
+
+  FakeLoop loop;
+  loop.chunk = chunk;
+
+  auto sender = send(loop, PAYLOADS, startbyte, scratch_size);
+  sender.start();
+  while (loop.poll()) {
+  }
+  REQUIRE(sender.done());
+  CHECK(sender.result());
+
+  std::vector<uint8_t> expected;
+  for (auto const &payload : PAYLOADS) {
+    slipc::encode(payload, std::back_inserter(expected), startbyte);
+  }
+  CHECK(loop.output == expected);
+
+  SECTION("Frames come back in order") {
+    loop.input = loop.output;
+    auto reader = collect(loop, startbyte, 32);
+    reader.start();
+    while (loop.poll()) {
+    }
+    REQUIRE(reader.done());
+    CHECK(reader.result() == PAYLOADS);
+  }
+
+  SECTION("Oversize frames are dropped") {
+    loop.input = loop.output;
+    auto reader = collect(loop, startbyte, 8);
+    reader.start();
+    while (loop.poll()) {
+    }
+    REQUIRE(reader.done());
+    CHECK(reader.result() == std::vector<std::vector<uint8_t>>{
+                                 PAYLOADS[0], PAYLOADS[1], PAYLOADS[2]});
+  }
+}
+
+TEST_CASE("Coroutine frame stream closed writer", "[cpp][async]") {
+  FakeLoop loop;
+  loop.chunk = 4;
+  loop.write_limit = 6;
+
+  auto sender = send(loop, PAYLOADS, false, 8);
+  sender.start();
+  while (loop.poll()) {
+  }
+  REQUIRE(sender.done());
+  CHECK(!sender.result());
+  CHECK(loop.output.size() == 6);
+}
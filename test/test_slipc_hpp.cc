@@ -0,0 +1,149 @@
+#include "catch2/catch_test_macros.hpp"
+#include "catch2/generators/catch_generators.hpp"
+
+#include <cstdint>
+#include <iterator>
+#include <random>
+#include <span>
+#include <vector>
+
+#include "slipc.hpp"
+#include "slipc_io.h"
+
+// Unlike test_slipc.cc the C API lives in the global namespace here, as
+// slipc.hpp pulls in slipc.h itself.
+
+static std::vector<uint8_t> random_bytes(std::mt19937 &rng, size_t len,
+                                         unsigned special_permille) {
+  std::uniform_int_distribution<unsigned> byte_dist(0, 255);
+  std::uniform_int_distribution<unsigned> permille_dist(0, 999);
+  uint8_t const specials[] = {SLIPC_END, SLIPC_ESC, SLIPC_ESC_END,
+                              SLIPC_ESC_ESC};
+  std::vector<uint8_t> bytes(len);
+  for (auto &byte : bytes) {
+    byte = permille_dist(rng) < special_permille ? specials[byte_dist(rng) % 4]
+                                                 : byte_dist(rng);
+  }
+  return bytes;
+}
+
+struct CDecode {
+  slipc_decoder_result_t result;
+  std::vector<uint8_t> decoded;
+  bool malformed;
+};
+
+static CDecode c_decode(std::vector<uint8_t> const &encoded, bool startbyte) {
+  uint8_t dummy = 0;
+  std::vector<uint8_t> out(encoded.size() + 1);
+  slipc_io_buffer_writer_t buffer;
+  auto writer = slipc_io_writer_from_buffer(&buffer, out.data(), out.size());
+  auto decoder = slipc_decoder_new(startbyte);
+  auto res = slipc_decoder_decode_packet(
+      &decoder, &writer, encoded.empty() ? &dummy : encoded.data(),
+      encoded.size());
+  out.resize(out.size() - buffer.len);
+  return {res, out, decoder.malformed};
+}
+
+static slipc::decode_status to_status(slipc_decoder_result_t res) {
+  switch (res) {
+  case SLIPC_DECODER_EOF:
+    return slipc::decode_status::eof;
+  case SLIPC_DECODER_MORE:
+    return slipc::decode_status::more;
+  default:
+    return slipc::decode_status::not_found;
+  }
+}
+
+TEST_CASE("C++ encode", "[cpp][encode]") {
+  std::mt19937 rng(18);
+  auto startbyte = GENERATE(false, true);
+  auto special_permille = GENERATE(0u, 100u, 1000u);
+
+  for (size_t len : {0u, 1u, 15u, 64u, 1000u}) {
+    auto payload = random_bytes(rng, len, special_permille);
+
+    uint8_t dummy = 0;
+    std::vector<uint8_t> expected(SLIPC_ENCODED_SIZE_MAX(len, startbyte));
+    slipc_io_buffer_writer_t buffer;
+    auto writer =
+        slipc_io_writer_from_buffer(&buffer, expected.data(), expected.size());
+    REQUIRE(slipc_encode_packet(&writer, len ? payload.data() : &dummy, len,
+                                startbyte) == SLIPC_ENCODER_OK);
+    expected.resize(expected.size() - buffer.len);
+
+    std::vector<uint8_t> encoded;
+    slipc::encode(payload, std::back_inserter(encoded), startbyte);
+    CHECK(encoded == expected);
+    CHECK(slipc::encoded_size(payload, startbyte) == expected.size());
+
+    std::vector<uint8_t> exact(expected.size());
+    CHECK(slipc::encode(payload, std::span(exact), startbyte) == exact.size());
+    CHECK(exact == expected);
+
+    std::vector<uint8_t> small(expected.size() - 1);
+    CHECK(slipc::encode(payload, std::span(small), startbyte) == 0);
+  }
+}
+
+TEST_CASE("C++ decode", "[cpp][decode]") {
+  std::mt19937 rng(81);
+  auto startbyte = GENERATE(false, true);
+  auto special_permille = GENERATE(0u, 100u, 500u);
+
+  for (size_t len : {0u, 1u, 2u, 15u, 64u, 1000u}) {
+    auto encoded = random_bytes(rng, len, special_permille);
+    auto expected = c_decode(encoded, startbyte);
+
+    std::vector<uint8_t> decoded;
+    auto res = slipc::decode(encoded, std::back_inserter(decoded), startbyte);
+    CHECK(res.status == to_status(expected.result));
+    CHECK(res.malformed == expected.malformed);
+    CHECK(decoded == expected.decoded);
+  }
+}
+
+TEST_CASE("C++ decode into a span", "[cpp][decode]") {
+  std::vector<uint8_t> const encoded{1, SLIPC_ESC, SLIPC_ESC_END, 2, SLIPC_END};
+  std::vector<uint8_t> out(3);
+  std::span<uint8_t> const dst(out);
+
+  SECTION("Fits") {
+    auto res = slipc::decode(encoded, dst);
+    CHECK(res.status == slipc::decode_status::eof);
+    CHECK(res.consumed == encoded.size());
+    CHECK(res.out - dst.begin() == 3);
+    CHECK(out == std::vector<uint8_t>{1, SLIPC_END, 2});
+  }
+
+  SECTION("Output full before an escape") {
+    auto const first = dst.first(1);
+    auto res = slipc::decode(encoded, first);
+    CHECK(res.status == slipc::decode_status::more);
+    CHECK(res.consumed == 1);
+    CHECK(res.out - first.begin() == 1);
+  }
+
+  SECTION("Input ends after an escape") {
+    std::vector<uint8_t> input{1, SLIPC_ESC};
+    auto res = slipc::decode(input, dst);
+    CHECK(res.status == slipc::decode_status::more);
+    CHECK(res.consumed == 1);
+    CHECK(res.out - dst.begin() == 1);
+
+    // The caller resumes at consumed once the rest has arrived.
+    input.erase(input.begin(), input.begin() + res.consumed);
+    input.insert(input.end(), {SLIPC_ESC_END, SLIPC_END});
+    auto const rest = dst.subspan(1);
+    res = slipc::decode(input, rest);
+    CHECK(res.status == slipc::decode_status::eof);
+    CHECK(res.consumed == input.size());
+    CHECK(res.out - rest.begin() == 1);
+    CHECK(out[0] == 1);
+    CHECK(out[1] == SLIPC_END);
+  }
+
+  static_assert(slipc::encoded_size(std::span<uint8_t const>{}) == 1);
+}